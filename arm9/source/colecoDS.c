@@ -25,6 +25,7 @@
 #include "highscore.h"
 #include "colecogeneric.h"
 #include "colecomngt.h"
+#include "pagedrom.h"
 #include "cpu/tms9918a/tms9918a.h"
 #include "cpu/z80/ctc.h"
 #include "intro.h"
@@ -68,6 +69,8 @@
 #include "MTX_BIOS.h"
 #include "C24XX.h"
 #include "screenshot.h"
+#include "vdpcapture.h"
+#include "vgmlog.h"
 #include "cpu/z80/Z80_interface.h"
 #include "cpu/scc/SCC.h"
 
@@ -366,6 +369,60 @@ u32 keyCoresp[MAX_KEY_OPTIONS] __attribute__((section(".dtcm"))) = {
 u16 GAME_SPEED_NTSC[] __attribute__((section(".dtcm"))) = {546, 497, 455, 420, 607, 679 };
 u16 GAME_SPEED_PAL[]  __attribute__((section(".dtcm"))) = {656, 596, 547, 505, 729, 818 };
 
+// --------------------------------------------------------------------------------
+// Auto frameskip... after each frame we look at how long that one frame took to
+// emulate (in Timer2 ticks, not counting any time spent waiting for the frame
+// deadline or the vertical blank) and only skip rendering the next frame when we
+// have been running late. Each frame is judged on its own so one slow frame can't
+// make every later frame in the timing window look late. Some hysteresis keeps us
+// from flip-flopping in and out of skipping and we never skip more than a couple
+// of frames in a row.
+// --------------------------------------------------------------------------------
+#define AUTO_SKIP_LATE_FRAMES   2       // This many late frames in a row before we start skipping
+#define AUTO_SKIP_EARLY_FRAMES  30      // This many comfortable frames in a row before we stop skipping
+#define AUTO_SKIP_MARGIN        64      // Timer2 ticks (about 2ms) of headroom needed to count as comfortable
+#define AUTO_SKIP_MAX_RUN       2       // Never skip more than this many frames in a row
+
+u8  auto_skip_late      __attribute__((section(".dtcm"))) = 0;
+u8  auto_skip_early     __attribute__((section(".dtcm"))) = 0;
+u8  auto_skip_run       __attribute__((section(".dtcm"))) = 0;
+u8  auto_skip_enabled   __attribute__((section(".dtcm"))) = 0;
+u16 auto_skip_count     __attribute__((section(".dtcm"))) = 0;    // Frames skipped in the last second - shown with the FPS
+u16 auto_skip_start     __attribute__((section(".dtcm"))) = 0;    // Timer2 when the work for this frame started
+u16 vsync_wait_ticks    __attribute__((section(".dtcm"))) = 0;    // Timer2 ticks spent in swiWaitForVBlank() this frame
+
+ITCM_CODE void AutoFrameSkip(s32 slack)
+{
+    extern u8 frameSkip[];
+
+    if (slack < 0)  // We overran the deadline
+    {
+        auto_skip_early = 0;
+        if (auto_skip_late < 255) auto_skip_late++;
+    }
+    else if (slack > AUTO_SKIP_MARGIN)  // Plenty of time to spare
+    {
+        auto_skip_late = 0;
+        if (auto_skip_early < 255) auto_skip_early++;
+    }
+
+    if (auto_skip_late  >= AUTO_SKIP_LATE_FRAMES)  auto_skip_enabled = 1;
+    if (auto_skip_early >= AUTO_SKIP_EARLY_FRAMES) auto_skip_enabled = 0;
+
+    // Skip the next frame only if we are still behind and haven't skipped too many already
+    if (auto_skip_enabled && (slack < 0) && (auto_skip_run < AUTO_SKIP_MAX_RUN))
+    {
+        frameSkip[FRAME_SKIP_AUTO] = 0x00;
+        auto_skip_run++;
+        auto_skip_count++;
+    }
+    else
+    {
+        frameSkip[FRAME_SKIP_AUTO] = 0xFF;
+        auto_skip_run = 0;
+    }
+}
+
 // --------------------------------------------------------------------------------
 // Spinners! X and Y taken together will actually replicate the roller controller.
 // --------------------------------------------------------------------------------
@@ -397,204 +454,700 @@ void SoundUnPause(void)
 // We were using the normal ARM7 sound core but it sounded "scratchy" and so with the help
 // of FluBBa, we've swiched over to the maxmod sound core which performs much better.
 // --------------------------------------------------------------------------------------------
-#define sample_rate         (27965)    // To match the driver in sn76496 - this is good enough quality for the DS
 #define buffer_size         (512+16)   // Enough buffer that we don't have to fill it too often. Must be multiple of 16.
 
 mm_ds_system sys   __attribute__((section(".dtcm")));
 mm_stream myStream __attribute__((section(".dtcm")));
 
-s16 mixbuf1[4096+64];      // When we have SN and AY sound we have to mix 3+3 channels
-s16 mixbuf2[4096+64];      // into a single output so we render to mix buffers first.
+s16 mixbuf1[4096+64];      // When we have more than one sound chip each renders into
+s16 mixbuf2[4096+64];      // its own mix buffer and the results are combined into
+s16 mixbuf3[4096+64];      // a single output (see SoundRender() below).
+s16 mixbuf4[4096+64];
 
-#define WAVE_DIRECT_BUF_SIZE 4095
-u16 mixer_read      __attribute__((section(".dtcm"))) = 0;
-u16 mixer_write     __attribute__((section(".dtcm"))) = 0;
-u8 wave_direct_skip __attribute__((section(".dtcm"))) = 0;
+// -------------------------------------------------------------------------------------------
+// For the 'Wave Direct' driver every sound chip write is queued up with the time it happened
+// (in output samples, 24.8 fixed point) and OurSoundMixer() renders each buffer in one pass -
+// stopping only long enough to apply each write at its exact sample position. This lets games that play digitized
+// speech by hammering the volume registers sound right for about the cost of the normal
+// driver. The output trails the emulation by SOUND_QUEUE_LATENCY samples so that a full
+// frame of writes is always queued ahead of the buffer being rendered.
+// -------------------------------------------------------------------------------------------
+#define SOUND_QUEUE_SIZE    2048                // Pending sound chip writes - must be a power of 2
+#define SOUND_QUEUE_LATENCY (3*512)             // Output samples we trail the emulation by (about a frame plus one buffer)
 
-s16 mixer[WAVE_DIRECT_BUF_SIZE+1];
+#define SND_CHIP_SN         0
+#define SND_CHIP_AY         1
+#define SND_CHIP_SCC        2
 
-// -------------------------------------------------------------------------
-// For direct sampling, this tells us for a given scanline how many samples
-// to process... this gets us to the magic sample_rate. Crude but effective.
-// -------------------------------------------------------------------------
-u8 wave_direct_sample_table[256] __attribute__((section(".dtcm"))) = 
+typedef struct
 {
-  2,1,2,2,2,2,1,2,     2,2,1,2,2,2,2,2,
-  2,2,1,2,2,2,1,2,     2,2,2,1,2,2,2,1,
-  2,2,2,1,2,2,2,2,     2,1,2,2,1,2,2,2,
-  2,2,2,2,1,2,2,2,     2,2,2,2,2,1,2,2,
-
-  2,2,1,2,2,1,2,2,     2,2,2,1,2,2,1,2,
-  2,2,2,2,2,2,1,2,     2,1,2,2,2,2,2,1,
-  2,2,2,2,2,2,2,1,     1,2,2,2,2,2,2,2,
-  1,2,2,2,2,2,2,2,     2,1,2,2,2,2,1,2,
-
-  2,1,2,2,2,1,2,2,     2,2,2,2,2,2,1,2,
-  2,2,2,2,2,2,1,2,     2,1,2,2,2,1,2,1,
-  2,2,2,2,2,2,2,1,     1,2,2,1,2,2,2,2,
-  1,2,2,2,2,1,2,2,     2,1,2,2,2,2,2,1,
-
-  2,1,2,2,2,2,2,2,     2,2,1,2,2,2,1,2,
-  2,2,1,2,2,2,2,2,     2,1,2,1,2,2,2,1,
-  2,2,2,1,2,2,2,2,     2,2,2,2,1,2,2,2,
-  2,2,2,2,1,2,2,2,     2,1,2,2,2,1,2,2
-};
+    u32 pos;                                    // Output sample position (24.8) of the write
+    u8  chip;                                   // SND_CHIP_xxx
+    u8  reg;                                    // AY register or SCC address (low byte)
+    u8  value;
+    u8  spare;
+} tSoundWrite;
+
+tSoundWrite sound_queue[SOUND_QUEUE_SIZE];
+vu16 sound_queue_head   __attribute__((section(".dtcm"))) = 0;    // Only moved by the emulation
+vu16 sound_queue_tail   __attribute__((section(".dtcm"))) = 0;    // Only moved by OurSoundMixer() or with interrupts off
+u32  sound_emu_pos      __attribute__((section(".dtcm"))) = 0;    // Emulated time in output samples (24.8) - advanced every scanline
+u32  sound_out_pos      __attribute__((section(".dtcm"))) = 0;    // Emulated time of the next sample OurSoundMixer() outputs
+u32  sound_line_step    __attribute__((section(".dtcm"))) = 0;    // Output samples per scanline (24.8)
+u32  sound_cycle_step   __attribute__((section(".dtcm"))) = 0;    // Output samples per CPU cycle (16.16)
+u8   sound_ay_regs[16]  __attribute__((section(".dtcm"))) = {0};  // AY registers as the emulated program last wrote them
 
+// -------------------------------------------------------------------------------------------
+// How well the queue is keeping up - counted as we go and latched once a second for the
+// debugger so we can tell when it's the sound output rather than the video that stalls.
+// An underrun is the output catching up with the emulation (nothing queued to play yet) and
+// an overrun is the emulation getting so far ahead that samples are dropped or the queue
+// fills - 'late' counts writes that arrived after the sample they were meant for.
+// -------------------------------------------------------------------------------------------
+typedef struct
+{
+    u16 underruns;
+    u16 overruns;
+    u16 late;
+    u16 peak;                                   // Most writes waiting in the queue at once
+    u32 dropped;                                // Output samples skipped to catch back up
+    u32 repeated;                               // Output samples played again to wait for the emulation
+    s32 fill;                                   // Samples the emulation was ahead by at the last buffer
+} tSoundStats;
+
+tSoundStats sound_stats      __attribute__((section(".dtcm")));
+tSoundStats sound_stats_last;
 
 // -------------------------------------------------------------------------------------------
-// maxmod will call this routine when the buffer is half-empty and requests that
-// we fill the sound buffer with more samples. They will request 'len' samples and
-// we will fill exactly that many. If the sound is paused, we fill with 'mute' samples.
+// The chips are rendered at a slightly variable rate and resampled to the output so the
+// queue stays at its target fill (see SoundQueueRender). Rates are chip samples per output
+// sample in 16.16 fixed point. The rate is always the output rate give or take the trim -
+// following the GAME SPEED setting would change the pitch of everything that plays.
 // -------------------------------------------------------------------------------------------
-s16 last_sample __attribute__((section(".dtcm"))) = 0;
-int breather    __attribute__((section(".dtcm"))) = 0;
-ITCM_CODE mm_word OurSoundMixer(mm_word len, mm_addr dest, mm_stream_formats format)
+#define SOUND_RATE_BASE     0x10000             // One chip sample per output sample
+#define SOUND_RATE_TRIM     (0x10000/200)       // Never trim the rate by more than 0.5% - far too little to hear
+#define SOUND_LAG_SLACK     (SOUND_QUEUE_LATENCY/2) // Output samples of error the trim is left to take up
+#define SOUND_RS_CHUNK      1024                // Output samples resampled at a time
+
+s16  sound_rs_buf[2 + SOUND_RS_CHUNK + (SOUND_RS_CHUNK/64) + 4];   // Two samples of history then the chip samples for one chunk
+u32  sound_rate         __attribute__((section(".dtcm"))) = SOUND_RATE_BASE; // Chip samples per output sample (16.16)
+s32  sound_rs_phase     __attribute__((section(".dtcm"))) = 0;      // Position of the next output sample past sound_rs_buf[1] (16.16)
+u8   sound_rs_primed    __attribute__((section(".dtcm"))) = 0;      // Zero until the history has been filled
+
+static const u8 ay_reg_mask[16] = {0xFF,0x0F,0xFF,0x0F,0xFF,0x0F,0x1F,0xFF, 0x1F,0x1F,0x1F,0xFF,0xFF,0x0F,0xFF,0xFF};
+
+// -------------------------------------------------------------------------------------------
+// The sound output is built from a small mixing graph with one source per sound chip the
+// machine is using. Each source renders a block into its own buffer - at (1<<shift) times
+// the output rate for chips that need it - and a single pass then folds them together with
+// their gain and clips the result. The graph is rebuilt on the first buffer after the chips
+// are reset and again if a game switches a chip on later (the SGM AY or the Konami SCC).
+// -------------------------------------------------------------------------------------------
+#define MIX_MAX_SOURCES     4
+#define MIX_UNITY           256                 // Source gain of 1.0 (8.8 fixed point)
+
+#define MIX_SRC_SN          0x01                // The SN chip also makes the PV-1000 tones
+#define MIX_SRC_AY          0x02
+#define MIX_SRC_SCC         0x04
+#define MIX_SRC_BEEP        0x08                // The MSX/Einstein 1-bit beeper used by a few ZX Spectrum ports
+
+typedef struct
 {
-    if (soundEmuPause)  // If paused, just "mix" in mute sound chip... all channels are OFF
+    void (*render)(int len, s16 *dest);         // Renders 'len' samples from the chip
+    u8   (*steady)(void);                       // Non-zero if the chip output can't change until its registers are written
+    void (*skip)(int len);                      // Called instead of render() while held - for a chip with its own clock (may be 0)
+    s16 *buf;                                   // Block the chip renders into
+    s32 zero;                                   // What the chip outputs when it is silent
+    s16 gain;                                   // 8.8 fixed point
+    s16 hold;                                   // The sample the chip is holding while it is steady
+    u8  shift;                                  // Chip runs at (1<<shift) times the output rate and is averaged down
+    u8  id;                                     // MIX_SRC_xxx
+} tMixSource;
+
+tMixSource mix_source[MIX_MAX_SOURCES] __attribute__((section(".dtcm")));
+u8  mix_sources     __attribute__((section(".dtcm"))) = 0;      // Number of sources in use
+u8  mix_config      __attribute__((section(".dtcm"))) = 0xFF;   // MIX_SRC_xxx bits the graph was built for
+s32 mix_zero        __attribute__((section(".dtcm"))) = 0;      // Output sample for silence
+vu8 mix_held        __attribute__((section(".dtcm"))) = 0;      // MIX_SRC_xxx bits for chips holding a steady output - cleared by any write
+u32 mix_samples     __attribute__((section(".dtcm"))) = 0;      // Chip samples asked for since the last once/second update...
+u32 mix_skipped     __attribute__((section(".dtcm"))) = 0;      // ...and how many of those were filled in without rendering
+u8  mix_skip_pct    __attribute__((section(".dtcm"))) = 0;      // Percentage skipped over the last second (for the debugger)
+
+// The SN and AY can either be oversampled or rendered with band-limited steps at the output rate (less CPU)
+ITCM_CODE static void MixRenderSN(int len, s16 *dest)  {if (myConfig.soundRender) sn76496MixerBL(len, dest, &mySN); else sn76496Mixer(len, dest, &mySN);}
+ITCM_CODE static void MixRenderAY(int len, s16 *dest)  {if (myConfig.soundRender) ay38910MixerBL(len, dest, &myAY); else ay38910Mixer(len, dest, &myAY);}
+ITCM_CODE static void MixRenderSCC(int len, s16 *dest) {SCCMixer(len, dest, &mySCC);}
+
+// -------------------------------------------------------------------------------------------
+// A chip is steady when nothing it outputs can change on its own - every SN channel fully
+// attenuated, every AY channel either at zero volume or with tone and noise both disabled
+// (a fixed level, as used for digitized speech) and no envelope, and every SCC channel at
+// zero volume. Many games leave the chips like this for long stretches.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE static u8 MixSteadySN(void)
+{
+    return ((mySN.ch0Att & mySN.ch1Att & mySN.ch2Att & mySN.ch3Att & 0x0F) == 0x0F);
+}
+
+ITCM_CODE static u8 MixSteadyAY(void)
+{
+    for (u8 ch=0; ch<3; ch++)
     {
-        s16 *p = (s16*)dest;
-        for (int i=0; i<len*2; i++)
-        {
-           *p++ = last_sample;      // To prevent pops and clicks... just keep outputting the last sample
-        }
+        u8 vol = myAY.ayRegs[8+ch];
+        if (vol & 0x10) return 0;                                       // Envelope is always moving
+        if (vol && ((myAY.ayRegs[7] & (0x09 << ch)) != (0x09 << ch))) return 0;   // Tone or noise enabled at some volume
     }
-    else if (myConfig.soundDriver) // Sound driver is either SND_DRV_WAVE or SND_DRV_BEEPER
+    return 1;
+}
+
+ITCM_CODE static u8 MixSteadySCC(void)
+{
+    return !((mySCC.ch0Volume | mySCC.ch1Volume | mySCC.ch2Volume | mySCC.ch3Volume | mySCC.ch4Volume) & 0x0F);
+}
+
+// -------------------------------------------------------------------------------------------
+// The 1-bit beeper. Rather than guess a tone from how often the beeper was hit each frame,
+// every change of level is queued with the emulated time it happened and the beeper is
+// rendered as a real square wave - each edge smoothed with the same polyBLEP as the
+// band-limited SN/AY renderers. The beeper keeps its own output clock trailing the
+// emulation by SOUND_QUEUE_LATENCY (as the 'Wave Direct' queue does) so it works with
+// either sound driver, and once it stops moving it is held like any other steady chip.
+// -------------------------------------------------------------------------------------------
+#define BEEP_QUEUE_SIZE     1024                // Pending level changes - must be a power of 2
+#define BEEP_AMPLITUDE      0x1800              // About where the old SN approximation sat
+
+typedef struct
+{
+    u32 pos;                                    // Output sample position (24.8) of the change
+    u8  level;                                  // New beeper level (0 or 1)
+    u8  spare[3];
+} tBeepEdge;
+
+tBeepEdge beep_queue[BEEP_QUEUE_SIZE];
+vu16 beep_queue_head    __attribute__((section(".dtcm"))) = 0;      // Only moved by the emulation
+vu16 beep_queue_tail    __attribute__((section(".dtcm"))) = 0;      // Only moved by the beeper renderer
+u32  beep_out_pos       __attribute__((section(".dtcm"))) = 0;      // Emulated time of the next beeper sample
+s32  beep_out_level     __attribute__((section(".dtcm"))) = 0;      // Output level before the BLEP correction
+s32  beep_carry         __attribute__((section(".dtcm"))) = 0;      // BLEP correction owed to the next sample
+u8   beep_level         __attribute__((section(".dtcm"))) = 0;      // Level last set by the emulated program
+
+// -------------------------------------------------------------------------------------------
+// A step of 'delta' that happened 'frac' (1/256ths of a sample) before the end of the
+// sample - see SN76496_BL.c.
+// -------------------------------------------------------------------------------------------
+static inline __attribute__((always_inline)) void beepStep(s32 delta, u32 frac, s32 *before)
+{
+    u32 early = 256 - frac;
+    *before    += (delta * (s32)((frac*frac) >> 9)) >> 8;
+    beep_carry -= (delta * (s32)((early*early) >> 9)) >> 8;
+}
+
+ITCM_CODE static void MixRenderBeep(int len, s16 *dest)
+{
+    s32 lag = (s32)(sound_emu_pos - beep_out_pos) - (SOUND_QUEUE_LATENCY << 8);
+    if ((lag < -(SOUND_QUEUE_LATENCY << 8)) || (lag > (SOUND_QUEUE_LATENCY << 9)))
     {
-        s16 *p = (s16*)dest;
-        for (int i=0; i<len*2; i++)
+        beep_out_pos += lag;                    // Been idle (or paused) - pick the emulation back up
+        lag = 0;
+    }
+    else if (lag > (SOUND_LAG_SLACK << 8))     // GAME SPEED away from 100% - drop or repeat as the chips do
+    {
+        beep_out_pos += lag - (SOUND_LAG_SLACK << 8);
+        lag = (SOUND_LAG_SLACK << 8);
+    }
+    else if (lag < -(SOUND_LAG_SLACK << 8))
+    {
+        beep_out_pos += lag + (SOUND_LAG_SLACK << 8);
+        lag = -(SOUND_LAG_SLACK << 8);
+    }
+
+    s32 level = beep_out_level;
+    u32 t = beep_out_pos;
+    for (int i=0; i<len; i++)
+    {
+        t += 256;
+        s32 out = level + beep_carry;
+        beep_carry = 0;
+        while (beep_queue_tail != beep_queue_head)
         {
-            if (mixer_read == mixer_write) {wave_direct_skip=0; if (pv1000_mode) processDirectAudioSN(); else processDirectAudio();}
-            *p++ = mixer[mixer_read];
-            mixer_read = (mixer_read + 1) & WAVE_DIRECT_BUF_SIZE;
+            const tBeepEdge *e = &beep_queue[beep_queue_tail];
+            s32 frac = (s32)(t - e->pos);
+            if (frac < 0) break;                // Not until a later sample
+            if (frac > 256) frac = 256;         // Late - step right at the start of this sample
+            s32 now = (e->level ? BEEP_AMPLITUDE : 0);
+            if (now != level) {beepStep(now - level, frac, &out); level = now;}
+            beep_queue_tail = (beep_queue_tail+1) & (BEEP_QUEUE_SIZE-1);
         }
-        p--; last_sample = *p;
-        if (breather) {breather -= (len*2); if (breather < 0) breather = 0;}
+        *dest++ = (s16)out;
     }
-    else
+    beep_out_level = level;
+
+    // Nudge the clock about 1/32 of the error per buffer worth of samples - no more than the chip rate trim
+    s32 nudge = ((lag >> 7) * len) >> 8;
+    s32 limit = (len << 8) / 200;
+    if (nudge > limit) nudge = limit;
+    else if (nudge < -limit) nudge = -limit;
+    beep_out_pos += (len << 8) + nudge;
+}
+
+ITCM_CODE static u8 MixSteadyBeep(void)
+{
+    return ((beep_queue_tail == beep_queue_head) && !beep_carry);
+}
+
+// While held, the beeper clock must still move on or the next edge comes out late
+ITCM_CODE static void MixSkipBeep(int len)
+{
+    beep_out_pos += (len << 8);
+}
+
+// -------------------------------------------------------------------------------------------
+// Called by the MSX PPI and Einstein PSG port handlers with the new beeper level.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE void SoundWriteBeeper(u8 level)
+{
+    if (level == beep_level) return;
+
+    u16 head = beep_queue_head;
+    u16 next = (head+1) & (BEEP_QUEUE_SIZE-1);
+    if (next == beep_queue_tail) return;                // Output has stalled - the edge is lost
+
+    beep_level = level;
+    beep_queue[head].pos   = SoundTimeNow();
+    beep_queue[head].level = level;
+    __asm__ __volatile__("" ::: "memory");              // The entry must be complete before the renderer can see it
+    beep_queue_head = next;
+    mix_held &= ~MIX_SRC_BEEP;
+}
+
+static void MixAddSource(u8 id, void (*render)(int, s16 *), u8 (*steady)(void), void (*skip)(int), s16 *buf, s32 zero, u8 shift)
+{
+    tMixSource *src = &mix_source[mix_sources++];
+    src->render = render;
+    src->steady = steady;
+    src->skip   = skip;
+    src->buf    = buf;
+    src->zero   = zero;
+    src->gain   = MIX_UNITY;
+    src->hold   = zero;
+    src->shift  = shift;
+    src->id     = id;
+}
+
+// -------------------------------------------------------------------------------------------
+// Render a block from one source - or, if the chip has been steady since the last block it
+// rendered, just fill in the sample it settled on. A steady block is always rendered first
+// (and it must be long enough for the chip filters to settle) so we know the level to hold.
+// Writes reach the chips in SoundQueueApply() or SoundWriteXX() and clear the held bit.
+// -------------------------------------------------------------------------------------------
+#define MIX_HOLD_MIN    32
+ITCM_CODE static void MixRenderSource(tMixSource *src, int len, s16 *dest)
+{
+    len <<= src->shift;
+    mix_samples += len;
+
+    if (src->steady())
     {
-        if (machine_mode & (MODE_MSX | MODE_SVI | MODE_EINSTEIN))
+        if (mix_held & src->id)
         {
-          if (msx_scc_enable)   // If SCC is enabled, we need to mix the AY with the SCC chips
-          {
-              ay38910Mixer(len*2, mixbuf1, &myAY);
-              SCCMixer(len*4, mixbuf2, &mySCC);
-              
-              s16 *p = (s16*)dest;
-              int j=0;
-              for (int i=0; i<len*2; i++)
-              {
-                  // ------------------------------------------------------------------------
-                  // We normalize the samples and mix them carefully to minimize clipping...
-                  // ------------------------------------------------------------------------
-                  s32 combined = (mixbuf1[i]) + ((mixbuf2[j] + mixbuf2[j+1])/2) + 32768;
-                  j+=2;
-                  if (combined >  32767) combined = 32767;
-                  *p++ = (s16)combined;
-              }
-              p--; last_sample = *p;
-          }
-          else  // Pretty simple... just AY
-          {
-              if (myConfig.msxBeeper) 
-              {
-                    // If the Beeper is active, we mix in the SN chip which is producing the key beeper tone
-                    ay38910Mixer(len*2, mixbuf1, &myAY);
-                    sn76496Mixer(len*2, mixbuf2, &mySN);
-                    s16 *p = (s16*)dest;
-                    for (int i=0; i<len*2; i++)
-                    {
-                        // ------------------------------------------------------------------------
-                        // We normalize the samples and mix them carefully to minimize clipping...
-                        // ------------------------------------------------------------------------
-                        s32 combined = (mixbuf1[i]) + (mixbuf2[i]) + 32768;
-                        if (combined >  32767) combined = 32767;
-                        *p++ = (s16)combined;
-                    }
-                    p--; last_sample = *p;
-              }
-              else
-              {
-                  ay38910Mixer(len*2, dest, &myAY);
-                  last_sample = ((s16*)dest)[len*2 - 1];
-              }
-          }
+            if (src->skip) src->skip(len);
+            u32 fill = (u16)src->hold | ((u32)src->hold << 16);
+            if ((u32)dest & 2) {*dest++ = src->hold; len--;}
+            u32 *p = (u32 *)dest;
+            for (int i=0; i<(len>>1); i++) *p++ = fill;
+            if (len & 1) dest[len-1] = src->hold;
+            mix_skipped += len;
+            return;
         }
-        else if (AY_Enable)  // If AY is enabled we mix the normal SN chip with the AY chip sound
+        src->render(len, dest);
+        if (len >= MIX_HOLD_MIN)
+        {
+            src->hold = dest[len-1];
+            mix_held |= src->id;
+        }
+        return;
+    }
+
+    mix_held &= ~src->id;
+    src->render(len, dest);
+}
+
+// -------------------------------------------------------------------------------------------
+// Which chips the current machine wants mixed...
+// -------------------------------------------------------------------------------------------
+ITCM_CODE static u8 SoundMixWanted(void)
+{
+    if (machine_mode & (MODE_MSX | MODE_SVI | MODE_EINSTEIN))
+    {
+        return MIX_SRC_AY | (myConfig.msxBeeper ? MIX_SRC_BEEP:0) | (msx_scc_enable ? MIX_SRC_SCC:0);
+    }
+    return MIX_SRC_SN | (AY_Enable ? MIX_SRC_AY:0);
+}
+
+// -------------------------------------------------------------------------------------------
+// The SN and AY output unsigned samples (silence is -32768) while the SCC and the beeper are
+// signed. The output keeps the unsigned form unless the SCC is mixed in.
+// -------------------------------------------------------------------------------------------
+static void SoundMixSetup(u8 config)
+{
+    mix_sources = 0;
+    mix_held    = 0;
+    if (config & MIX_SRC_AY)   MixAddSource(MIX_SRC_AY,   MixRenderAY,   MixSteadyAY,   0,           mixbuf1, -32768, 0);
+    if (config & MIX_SRC_SN)   MixAddSource(MIX_SRC_SN,   MixRenderSN,   MixSteadySN,   0,           mixbuf2, -32768, 0);
+    if (config & MIX_SRC_SCC)  MixAddSource(MIX_SRC_SCC,  MixRenderSCC,  MixSteadySCC,  0,           mixbuf3, 0,      1);
+    if (config & MIX_SRC_BEEP) MixAddSource(MIX_SRC_BEEP, MixRenderBeep, MixSteadyBeep, MixSkipBeep, mixbuf4, 0,      0);
+    mix_zero   = (config & MIX_SRC_SCC) ? 0 : -32768;
+    mix_config = config;
+}
+
+// -------------------------------------------------------------------------------------------
+// Render 'len' mono samples through the mixing graph. The DS ARM9 has QADD but no 16-bit
+// saturate so the clip is done with the usual shift compare - no branches in the common case.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE void SoundRender(int len, s16 *dest)
+{
+    u8 config = SoundMixWanted();
+    if (config != mix_config) SoundMixSetup(config);
+
+    // A single chip at unity gain doesn't need mixing at all
+    if ((mix_sources == 1) && (mix_source[0].shift == 0) && (mix_source[0].gain == MIX_UNITY))
+    {
+        MixRenderSource(&mix_source[0], len, dest);
+        return;
+    }
+
+    for (int s=0; s<mix_sources; s++)
+    {
+        MixRenderSource(&mix_source[s], len, mix_source[s].buf);
+    }
+
+    for (int i=0; i<len; i++)
+    {
+        s32 acc = mix_zero;
+        for (int s=0; s<mix_sources; s++)
         {
-            ay38910Mixer(len*2, mixbuf1, &myAY);
-            sn76496Mixer(len*2, mixbuf2, &mySN);
-            s16 *p = (s16*)dest;
-            for (int i=0; i<len*2; i++)
+            const tMixSource *src = &mix_source[s];
+            s32 sample;
+            if (src->shift)
             {
-                // ------------------------------------------------------------------------
-                // We normalize the samples and mix them carefully to minimize clipping...
-                // ------------------------------------------------------------------------
-                s32 combined = (mixbuf1[i]) + (mixbuf2[i]) + 32768;
-                if (combined >  32767) combined = 32767;
-                *p++ = (s16)combined;
+                const s16 *p = &src->buf[i << src->shift];
+                sample = 0;
+                for (int k=0; k<(1 << src->shift); k++) sample += p[k];
+                sample >>= src->shift;
             }
-            p--; last_sample = *p;
+            else sample = src->buf[i];
+            acc += ((sample - src->zero) * src->gain) >> 8;
         }
-        else  // This is the 'normal' case of just Colecovision SN sound chip output
+        if ((acc >> 15) != (acc >> 31)) acc = (acc >> 31) ^ 0x7FFF;
+        dest[i] = (s16)acc;
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+// Hand one queued write to its sound chip. The AY register index belongs to the emulated
+// program (it may be in the middle of an index/data pair) so we put it back afterwards.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE static void SoundQueueApply(const tSoundWrite *w)
+{
+    switch (w->chip)
+    {
+        case SND_CHIP_SN:
+            sn76496W(w->value, &mySN);
+            mix_held &= ~MIX_SRC_SN;
+            break;
+        case SND_CHIP_AY:
         {
-            sn76496Mixer(len*2, dest, &mySN);
-            last_sample = ((s16*)dest)[len*2 - 1];
+            u8 index = myAY.ayRegIndex;
+            ay38910IndexW(w->reg, &myAY);
+            ay38910DataW(w->value, &myAY);
+            myAY.ayRegIndex = index;
+            mix_held &= ~MIX_SRC_AY;
+            break;
         }
+        case SND_CHIP_SCC:
+            SCCWrite(w->value, 0x9800 | w->reg, &mySCC);
+            mix_held &= ~MIX_SRC_SCC;
+            break;
     }
+}
 
-    return  len;
+// -------------------------------------------------------------------------------------------
+// Apply every pending write right now - used before the chips are saved and if the queue
+// ever fills up (e.g. the sound output has been stalled).
+// -------------------------------------------------------------------------------------------
+void SoundQueueFlush(void)
+{
+    int oldIME = enterCriticalSection();
+    while (sound_queue_tail != sound_queue_head)
+    {
+        SoundQueueApply(&sound_queue[sound_queue_tail]);
+        sound_queue_tail = (sound_queue_tail+1) & (SOUND_QUEUE_SIZE-1);
+    }
+    leaveCriticalSection(oldIME);
 }
 
+// -------------------------------------------------------------------------------------------
+// Drop anything pending and set up the time base for the current machine. Called whenever
+// the sound chips are reset or reloaded - so the AY read-back copy is refreshed here too.
+// -------------------------------------------------------------------------------------------
+void SoundQueueReset(void)
+{
+    int oldIME = enterCriticalSection();
+    sound_queue_head = sound_queue_tail = 0;
+    sound_line_step  = ((sample_rate*2) << 8) / ((myConfig.isPAL ? TMS9929_FRAMES : TMS9918_FRAMES) * tms_num_lines);
+    sound_cycle_step = (sound_line_step << 8) / tms_cpu_line;
+    sound_out_pos    = sound_emu_pos - (SOUND_QUEUE_LATENCY << 8);
+    sound_rs_phase   = 0;
+    sound_rs_primed  = 0;
+    memset(&sound_stats, 0x00, sizeof(sound_stats));
+    memcpy(sound_ay_regs, myAY.ayRegs, sizeof(sound_ay_regs));
+    beep_queue_head  = beep_queue_tail = 0;
+    beep_out_pos     = sound_out_pos;
+    beep_out_level   = beep_carry = 0;
+    beep_level       = 0;
+    mix_held = 0;                                       // The chips may have been loaded with anything
+    leaveCriticalSection(oldIME);
+}
 
-// -------------------------------------------------------------------------------------------------
-// This is called when we are configured for 'Wave Direct' and will process samples to synchronize
-// with the scanline processing. This is not as smooth as the normal sound driver and takes more
-// CPU power but will help render sound those few games that utilize digitize speech techniques.
-// -------------------------------------------------------------------------------------------------
-ITCM_CODE void processDirectAudio(void)
+// -------------------------------------------------------------------------------------------
+// The current emulated time in output samples (24.8). The Z80 machines driven by the TMS9918
+// get the position within the scanline from the cycles already run - the CreatiVision and
+// the PV-1000 run their CPU differently and are timed to the start of the scanline.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE u32 SoundTimeNow(void)
 {
-    s16 mixbufA[8];
-    s16 mixbufB[8];
-    int len = wave_direct_sample_table[wave_direct_skip++];
-
-    ay38910Mixer(len*2, mixbufA, &myAY);
-    sn76496Mixer(len*2, mixbufB, &mySN);
-    if (breather) {return;}
-    s32 combined;
-    for (int i=0; i<len*2; i++)
-    {
-        // ------------------------------------------------------------------------
-        // We normalize the samples and mix them carefully to minimize clipping...
-        // ------------------------------------------------------------------------
-        combined = (mixbufA[i]) + (mixbufB[i]) + 32768;
-        if (combined >  32767) combined = 32767;
-        mixer[mixer_write] = (s16)combined;
-        mixer_write++; mixer_write &= WAVE_DIRECT_BUF_SIZE;
-        if (((mixer_write+1)&WAVE_DIRECT_BUF_SIZE) == mixer_read) {breather = 2048;}
+    u32 pos = sound_emu_pos;
+
+    if (!(creativision_mode || pv1000_mode))
+    {
+        s32 cycles = tms_cpu_line - CPU.ICount;
+        if (cycles < 0) cycles = 0;
+        else if (cycles > tms_cpu_line) cycles = tms_cpu_line;
+        pos += (cycles * sound_cycle_step) >> 8;
     }
+    return pos;
 }
 
+// -------------------------------------------------------------------------------------------
+// Queue a write at the current emulated time.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE static void SoundQueuePush(u8 chip, u8 reg, u8 value)
+{
+    u32 pos = SoundTimeNow();
 
-// -------------------------------------------------------------------------------------------------
-// This is called when we are configured for 'Wave Direct' and will process samples to synchronize
-// with the scanline processing. This particular routine only deals with the SN sound (not AY).
-// -------------------------------------------------------------------------------------------------
-ITCM_CODE void processDirectAudioSN(void)
+    u16 head = sound_queue_head;
+    u16 next = (head+1) & (SOUND_QUEUE_SIZE-1);
+    if (next == sound_queue_tail)                       // Output has stalled - fall back to applying the writes right away
+    {
+        sound_stats.overruns++;
+        SoundQueueFlush();
+    }
+    else
+    {
+        u16 fill = (head - sound_queue_tail) & (SOUND_QUEUE_SIZE-1);
+        if (fill >= sound_stats.peak) sound_stats.peak = fill+1;
+    }
+
+    tSoundWrite *w = &sound_queue[head];
+    w->pos   = pos;
+    w->chip  = chip;
+    w->reg   = reg;
+    w->value = value;
+    __asm__ __volatile__("" ::: "memory");              // The entry must be complete before OurSoundMixer() can see it
+    sound_queue_head = next;
+}
+
+// -------------------------------------------------------------------------------------------
+// All emulated sound chip accesses go through these so that the 'Wave Direct' driver can
+// queue them up. With the normal driver the writes go straight to the chips as before.
+// The held bit is only cleared once the chip has the write - if the mixer interrupted in
+// between it would see the chip still steady and hold the old level past the write.
+// -------------------------------------------------------------------------------------------
+#define MIX_RELEASE(id) do {__asm__ __volatile__("" ::: "memory"); mix_held &= ~(id);} while (0)
+
+ITCM_CODE void SoundWriteSN(u8 value)
+{
+    if (vgm_log_active) VGMLogWrite(VGM_CHIP_SN, 0, value);
+    if (myConfig.soundDriver) SoundQueuePush(SND_CHIP_SN, 0, value);
+    else {sn76496W(value, &mySN); MIX_RELEASE(MIX_SRC_SN);}
+}
+
+ITCM_CODE void SoundWriteAY(u8 value)
+{
+    u8 reg = myAY.ayRegIndex;
+    if (reg < 14)                                       // The two I/O ports (joysticks, keyboard, etc) always take effect right away
+    {
+        if (vgm_log_active) VGMLogWrite(VGM_CHIP_AY, reg, value);
+        sound_ay_regs[reg] = value & ay_reg_mask[reg];
+        if (myConfig.soundDriver) {SoundQueuePush(SND_CHIP_AY, reg, value); return;}
+        ay38910DataW(value, &myAY);
+        MIX_RELEASE(MIX_SRC_AY);
+        return;
+    }
+    ay38910DataW(value, &myAY);
+}
+
+ITCM_CODE u8 SoundReadAY(void)
+{
+    if (myAY.ayRegIndex < 14) return sound_ay_regs[myAY.ayRegIndex];    // Includes anything still waiting in the queue
+    return ay38910DataR(&myAY);
+}
+
+ITCM_CODE void SoundWriteSCC(u8 value, u16 address)
+{
+    if (vgm_log_active) VGMLogWrite(VGM_CHIP_SCC, address & 0xFF, value);
+    if (myConfig.soundDriver) SoundQueuePush(SND_CHIP_SCC, address & 0xFF, value);
+    else {SCCWrite(value, address, &mySCC); MIX_RELEASE(MIX_SRC_SCC);}
+}
+
+// -------------------------------------------------------------------------------------------
+// Once a second - keep what the sound output did over the last second for the debugger.
+// -------------------------------------------------------------------------------------------
+void SoundStatsLatch(void)
+{
+    int oldIME = enterCriticalSection();
+    sound_stats_last = sound_stats;
+    s32 fill = sound_stats.fill;
+    memset(&sound_stats, 0x00, sizeof(sound_stats));
+    sound_stats.fill = fill;
+    mix_skip_pct = (mix_samples ? (mix_skipped * 100) / mix_samples : 0);
+    mix_samples = mix_skipped = 0;
+    leaveCriticalSection(oldIME);
+}
+
+// -------------------------------------------------------------------------------------------
+// Render 'n' chip samples, applying the queued writes as we reach them. Writes that are late
+// (e.g. right after a pause) are applied at the first sample.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE static void SoundQueueRenderChips(int n, s16 *dest)
 {
-    s16 mixbufA[8];
-    int len = wave_direct_sample_table[wave_direct_skip++];
+    int done = 0;
+
+    while (sound_queue_tail != sound_queue_head)
+    {
+        const tSoundWrite *w = &sound_queue[sound_queue_tail];
+        s32 at = ((s32)(w->pos - sound_out_pos)) >> 8;
+        if (at >= n) break;                             // Not until a later buffer
+        if (at < 0) sound_stats.late++;
+        if (at > done)
+        {
+            SoundRender(at - done, dest + done);
+            done = at;
+        }
+        SoundQueueApply(w);
+        sound_queue_tail = (sound_queue_tail+1) & (SOUND_QUEUE_SIZE-1);
+    }
+    if (done < n) SoundRender(n - done, dest + done);
+
+    sound_out_pos += (n << 8);
+}
+
+// -------------------------------------------------------------------------------------------
+// Render 'len' samples for the 'Wave Direct' driver. The chips are run at sound_rate chip
+// samples per output sample and linearly resampled to the output - the rate is trimmed by up
+// to SOUND_RATE_TRIM either way to hold the queue at its target fill, so the emulation and
+// the output never drift apart however the frames are timed (PAL, vertical sync or not).
+// A GAME SPEED other than 100% makes sound faster or slower than the trim can follow, so
+// once the error passes SOUND_LAG_SLACK the difference is dropped (the output clock skips
+// ahead) or repeated (it steps back and the chips keep playing) - the pitch never changes.
+// Anything bigger, like a pause or a load, still simply snaps the output clock back.
+// -------------------------------------------------------------------------------------------
+ITCM_CODE void SoundQueueRender(int len, s16 *dest)
+{
+    s32 lag = (s32)(sound_emu_pos - sound_out_pos) - (SOUND_QUEUE_LATENCY << 8);
+
+    sound_stats.fill = (lag >> 8) + SOUND_QUEUE_LATENCY;
+    if ((lag < -(SOUND_QUEUE_LATENCY << 8)) || (lag > (SOUND_QUEUE_LATENCY << 9)))
+    {
+        if (lag < 0) sound_stats.underruns++;
+        else
+        {
+            sound_stats.overruns++;
+            sound_stats.dropped += lag >> 8;
+        }
+        sound_out_pos += lag;
+        lag = 0;
+    }
+    else if (lag > (SOUND_LAG_SLACK << 8))
+    {
+        sound_stats.dropped += (lag - (SOUND_LAG_SLACK << 8)) >> 8;
+        sound_out_pos += lag - (SOUND_LAG_SLACK << 8);
+        lag = (SOUND_LAG_SLACK << 8);
+    }
+    else if (lag < -(SOUND_LAG_SLACK << 8))
+    {
+        sound_stats.repeated += (-(SOUND_LAG_SLACK << 8) - lag) >> 8;
+        sound_out_pos += lag + (SOUND_LAG_SLACK << 8);
+        lag = -(SOUND_LAG_SLACK << 8);
+    }
+
+    // Take up about 1/32 of the error each buffer - no faster than the trim allows
+    s32 trim = (lag << 3) / len;
+    if (trim > SOUND_RATE_TRIM) trim = SOUND_RATE_TRIM;
+    else if (trim < -SOUND_RATE_TRIM) trim = -SOUND_RATE_TRIM;
+    sound_rate = SOUND_RATE_BASE + trim;
 
-    sn76496Mixer(len*2, mixbufA, &mySN);
-    if (breather) {return;}
-    for (int i=0; i<len*2; i++)
+    while (len > 0)
     {
-        mixer[mixer_write] = mixbufA[i];
-        mixer_write++; mixer_write &= WAVE_DIRECT_BUF_SIZE;
-        if (((mixer_write+1)&WAVE_DIRECT_BUF_SIZE) == mixer_read) {breather = 2048;}
+        int chunk = (len > SOUND_RS_CHUNK) ? SOUND_RS_CHUNK : len;
+
+        // Chip samples needed so the last output sample still has one either side of it
+        s32 phase = sound_rs_phase;
+        int n = ((phase + (s32)((chunk-1) * sound_rate)) >> 16) + 1;
+        if (n < 1) n = 1;
+
+        SoundQueueRenderChips(n, &sound_rs_buf[2]);
+        if (!sound_rs_primed)                           // Nothing to come from yet - start on the first sample
+        {
+            sound_rs_buf[0] = sound_rs_buf[1] = sound_rs_buf[2];
+            sound_rs_primed = 1;
+        }
+
+        // sound_rs_buf[1] is where the phase counts from and [0] is the sample before it
+        u32 pos = phase + 0x10000;
+        for (int i=0; i<chunk; i++)
+        {
+            const s16 *p = &sound_rs_buf[pos >> 16];
+            s32 a = p[0];
+            *dest++ = (s16)(a + (((p[1] - a) * (s32)((pos & 0xFFFF) >> 1)) >> 15));
+            pos += sound_rate;
+        }
+
+        sound_rs_phase = (s32)pos - 0x10000 - (n << 16);
+        sound_rs_buf[0] = sound_rs_buf[n];
+        sound_rs_buf[1] = sound_rs_buf[n+1];
+        len -= chunk;
     }
 }
 
 
+// -------------------------------------------------------------------------------------------
+// maxmod will call this routine when the buffer is half-empty and requests that
+// we fill the sound buffer with more samples. They will request 'len' samples and
+// we will fill exactly that many. If the sound is paused, we fill with 'mute' samples.
+// -------------------------------------------------------------------------------------------
+s16 last_sample __attribute__((section(".dtcm"))) = 0;
+ITCM_CODE mm_word OurSoundMixer(mm_word len, mm_addr dest, mm_stream_formats format)
+{
+    if (soundEmuPause)  // If paused, just "mix" in mute sound chip... all channels are OFF
+    {
+        s16 *p = (s16*)dest;
+        for (int i=0; i<len*2; i++)
+        {
+           *p++ = last_sample;      // To prevent pops and clicks... just keep outputting the last sample
+        }
+        return len;
+    }
+
+    if (myConfig.soundDriver) SoundQueueRender(len*2, (s16*)dest);  // 'Wave Direct' - sound writes land on their exact sample
+    else SoundRender(len*2, (s16*)dest);                             // Normal driver - writes land at the start of the next buffer
+
+    last_sample = ((s16*)dest)[len*2 - 1];
+
+    return  len;
+}
+
+
 // -------------------------------------------------------------------------------------------
 // Setup the maxmod audio stream - this will be a 16-bit Stereo PCM output at 55KHz which
 // sounds about right for the Colecovision.
@@ -643,9 +1196,8 @@ void sound_chip_reset()
 {
   memset(mixbuf1, 0x00, sizeof(mixbuf1));
   memset(mixbuf2, 0x00, sizeof(mixbuf2));
-  memset(mixer,   0x00, sizeof(mixer));
-  mixer_read=0;
-  mixer_write=0;
+  memset(mixbuf3, 0x00, sizeof(mixbuf3));
+  mix_config = 0xFF;               // Rebuild the mixing graph on the next sound buffer
 
   //  ------------------------------------------------------------------
   //  The SN sound chip is for normal Colecovision sound handling
@@ -689,6 +1241,8 @@ void sound_chip_reset()
   SCCWrite(0x00, 0x988F, &mySCC);
   
   SCCMixer(16, mixbuf2, &mySCC);     // Do an initial mix conversion to clear the output
+
+  SoundQueueReset();                 // Nothing pending for the 'Wave Direct' driver and the time base set for this machine
 }
 
 // -----------------------------------------------------------------------
@@ -1033,10 +1587,22 @@ void ShowDebugZ80(void)
         }
 
         sprintf(tmp, "Bank %02X [%02X] [%02X] EX=%d", (last_mega_bank != 199 ? last_mega_bank:0), romBankMask, mapperMask, adam_ext_ram_used);    DSPrint(0,idx++,7, tmp);
-        sprintf(tmp, "VMod %02X %4s %3s", TMS9918_Mode, VModeNames[TMS9918_Mode], ((TMS9918_VRAMMask == 0x3FFF) ? "16K":" 4K")); DSPrint(0,idx++,7, tmp);
+        sprintf(tmp, "VMod %02X %4s %3s %08lX", TMS9918_Mode, VModeNames[TMS9918_Mode], ((TMS9918_VRAMMask == 0x3FFF) ? "16K":" 4K"), vdp_frame_crc); DSPrint(0,idx++,7, tmp);
         sprintf(tmp, "Port P23=%02X P53=%02X P60=%02X P42=%02X", Port20, Port53, Port60, Port42); DSPrint(0,idx++,7, tmp);
         sprintf(tmp, "MEM Used %dK", getMemUsed()/1024); DSPrint(0,idx++,7, tmp);
         sprintf(tmp, "MEM Free %dK", getMemFree()/1024); DSPrint(0,idx++,7, tmp);
+        sprintf(tmp, "SND Skip %3d%% D%-6lu R%-6lu", mix_skip_pct, sound_stats_last.dropped, sound_stats_last.repeated); DSPrint(0,idx++,7, tmp);
+        sprintf(tmp, "SNDQ %-4ld/%-4d U%-3d O%-3d L%-4d", sound_stats_last.fill, sound_stats_last.peak, sound_stats_last.underruns, sound_stats_last.overruns, sound_stats_last.late); DSPrint(0,idx++,7, tmp);
+        if (b31_in_1)
+        {
+            u32 lookups = bank_cache_hits + bank_cache_misses;
+            sprintf(tmp, "B31 Hit %3ld%% H%-5lu M%-5lu", (lookups ? (bank_cache_hits * 100) / lookups : 0), bank_cache_hits, bank_cache_misses); DSPrint(0,idx++,7, tmp);
+        }
+        if (paged_rom)
+        {
+            u32 lookups = paged_rom_hits + paged_rom_misses;
+            sprintf(tmp, "PAGE Hit %3ld%% H%-5lu M%-5lu", (lookups ? (paged_rom_hits * 100) / lookups : 0), paged_rom_hits, paged_rom_misses); DSPrint(0,idx++,7, tmp);
+        }
 
         idx = 1;
         if (einstein_mode || sordm5_mode || memotech_mode)
@@ -3167,6 +3733,8 @@ void colecoDS_main(void)
   TIMER2_DATA=0;
   TIMER2_CR=TIMER_ENABLE  | TIMER_DIV_1024;
   timingFrames  = 0;
+  auto_skip_start  = 0;
+  vsync_wait_ticks = 0;
   emuFps=0;
 
   // Default SGM statics back to init state
@@ -3202,7 +3770,7 @@ void colecoDS_main(void)
         // -------------------------------------------------------------
         if (TIMER1_DATA >= 32728)   //  1000MS (1 sec)
         {
-            char szChai[4];
+            char szChai[6];
 
             TIMER1_CR = 0;
             TIMER1_DATA = 0;
@@ -3212,15 +3780,32 @@ void colecoDS_main(void)
             {
                 if (emuFps == 61) emuFps=60;
                 else if (emuFps == 59) emuFps=60;
-                if (emuFps/100) szChai[0] = '0' + emuFps/100;
-                else szChai[0] = ' ';
-                szChai[1] = '0' + (emuFps%100) / 10;
-                szChai[2] = '0' + (emuFps%100) % 10;
-                szChai[3] = 0;
+                if (myConfig.frameSkip == FRAME_SKIP_AUTO)  // Show as FPS-SKIPPED (e.g. 60-12)
+                {
+                    if (emuFps > 99) emuFps = 99;
+                    if (auto_skip_count > 99) auto_skip_count = 99;
+                    szChai[0] = '0' + emuFps / 10;
+                    szChai[1] = '0' + emuFps % 10;
+                    szChai[2] = '-';
+                    szChai[3] = '0' + auto_skip_count / 10;
+                    szChai[4] = '0' + auto_skip_count % 10;
+                    szChai[5] = 0;
+                }
+                else
+                {
+                    if (emuFps/100) szChai[0] = '0' + emuFps/100;
+                    else szChai[0] = ' ';
+                    szChai[1] = '0' + (emuFps%100) / 10;
+                    szChai[2] = '0' + (emuFps%100) % 10;
+                    szChai[3] = 0;
+                }
                 DSPrint(0,0,6,szChai);
             }
             DisplayStatusLine(false);
             emuActFrames = 0;
+            auto_skip_count = 0;
+            SoundStatsLatch();
+            VGMLogService();
 
             // A bit of a hack for the SC-3000 Survivors Multi-Cart
             if (sg1000_double_reset)
@@ -3232,6 +3817,7 @@ void colecoDS_main(void)
             if (myConfig.isPAL) myConfig.vertSync=0;    // Force Sync OFF always in PAL mode
         }
         emuActFrames++;
+        if (b31_in_1) Mega31in1Prefetch();     // Fill the 31-in-1 bank cache a little each frame
 
         // -------------------------------------------------------------
         // Vertical Sync reduces tearing but costs CPU time so this
@@ -3244,9 +3830,20 @@ void colecoDS_main(void)
             // the swiWaitForVBlank() call in TMS9918a.c
             // This way we keep tearing to a minimum.
             // --------------------------------------------
+            if (myConfig.frameSkip == FRAME_SKIP_AUTO)
+            {
+                // This frame's own time is everything since the last one ended less the wait for the vertical blank
+                u16 now = TIMER2_DATA;
+                u16 frame_ticks = (u16)(now - auto_skip_start) - vsync_wait_ticks;
+                auto_skip_start = now;
+                AutoFrameSkip((s32)(myConfig.isPAL ? GAME_SPEED_PAL[myConfig.gameSpeed]:GAME_SPEED_NTSC[myConfig.gameSpeed]) - (s32)frame_ticks);
+            }
         }
         else
         {
+            // This frame's own time - just the work since the wait below ended last frame
+            u16 frame_ticks = (u16)(TIMER2_DATA - auto_skip_start);
+
             // -------------------------------------------------------------------
             // We only support NTSC 60 frames... there are PAL colecovisions
             // but the games really don't adjust well and so we stick to basics.
@@ -3259,6 +3856,12 @@ void colecoDS_main(void)
                 timingFrames = 0;
             }
 
+            // See how much time we had to spare (negative if we overran) for the auto frameskip
+            if (myConfig.frameSkip == FRAME_SKIP_AUTO)
+            {
+                AutoFrameSkip((s32)(myConfig.isPAL ? GAME_SPEED_PAL[myConfig.gameSpeed]:GAME_SPEED_NTSC[myConfig.gameSpeed]) - (s32)frame_ticks);
+            }
+
             // ----------------------------------------------------------------------
             // Time 1 frame... 546 (NTSC) or 646 (PAL) ticks of Timer2
             // This is how we time frame-to frame to keep the game running at 60FPS
@@ -3269,6 +3872,7 @@ void colecoDS_main(void)
             {
                 if (myGlobalConfig.showFPS == 2) break;   // If Full Speed, break out...
             }
+            auto_skip_start = TIMER2_DATA;    // The next frame's work starts now
         }
 
       // If the Z80 Debugger is enabled, call it
@@ -3544,6 +4148,32 @@ void colecoDS_main(void)
                 WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
                 DSPrint(5,0,0,"        ");
           }
+          else if ((nds_key & KEY_L) && (nds_key & KEY_R) && (nds_key & KEY_A))
+          {
+                if (vdp_cap_buffer) DSPrint(5,0,0, (VDPCaptureStop()  ? "VDP SAVE" : "VDP FAIL"));
+                else                DSPrint(5,0,0, (VDPCaptureStart() ? "VDP REC " : "NO MEM  "));
+                WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+                DSPrint(5,0,0,"        ");
+          }
+          else if ((nds_key & KEY_L) && (nds_key & KEY_R) && (nds_key & KEY_SELECT))
+          {
+                DSPrint(5,0,0,"VDP PLAY");
+                switch (VDPReplay(vdp_cap_last[0] ? vdp_cap_last : "replay.vdp"))
+                {
+                    case VDP_REPLAY_OK:   DSPrint(5,0,0,"VDP DONE"); break;
+                    case VDP_REPLAY_DIFF: DSPrint(5,0,0,"VDP DIFF"); break;
+                    default:              DSPrint(5,0,0,"VDP FAIL"); break;
+                }
+                WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+                DSPrint(5,0,0,"        ");
+          }
+          else if ((nds_key & KEY_L) && (nds_key & KEY_R) && (nds_key & KEY_B))
+          {
+                if (vgm_log_active) DSPrint(5,0,0, (VGMLogStop()                   ? "VGM SAVE" : "VGM FAIL"));
+                else                DSPrint(5,0,0, (VGMLogStart(SoundMixWanted()) ? "VGM REC " : "VGM FAIL"));
+                WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+                DSPrint(5,0,0,"        ");
+          }
           else if  (nds_key & (KEY_UP | KEY_DOWN | KEY_LEFT | KEY_RIGHT | KEY_A | KEY_B | KEY_START | KEY_SELECT | KEY_R | KEY_L | KEY_X | KEY_Y))
           {
               if (myConfig.dpad == DPAD_SLIDE_N_GLIDE) // CHUCKIE-EGG Style... hold left/right or up/down for a few frames
@@ -215,6 +215,7 @@ extern u32 debug[0x10];
 extern u16 emuFps;
 extern u16 emuActFrames;
 extern u16 timingFrames;
+extern u16 vsync_wait_ticks;
 
 extern u8 msx_scc_enable;
 extern u8 sg1000_double_reset;
@@ -307,8 +308,20 @@ extern void ResetColecovision(void);
 extern u32  creativision_run(void);
 extern void msx_patch_bios(void);
 extern bool isAdamDDP(u8 disk);
-extern void processDirectAudio(void);
-extern void processDirectAudioSN(void);
+#define sample_rate         (27965)    // To match the driver in sn76496 - this is good enough quality for the DS
+
+extern u32  sound_emu_pos;
+extern u32  SoundTimeNow(void);
+extern u32  sound_line_step;
+extern u8   sound_ay_regs[16];
+extern void SoundWriteSN(u8 value);
+extern void SoundWriteAY(u8 value);
+extern u8   SoundReadAY(void);
+extern void SoundWriteSCC(u8 value, u16 address);
+extern void SoundWriteBeeper(u8 level);
+extern void SoundQueueFlush(void);
+extern void SoundQueueReset(void);
+extern void SoundStatsLatch(void);
 extern void processDirectBeeper(void);
 extern void processDirectBeeperAY4(u8 samples);
 extern void processDirectBeeperPlusAY(void);
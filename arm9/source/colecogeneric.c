@@ -1034,8 +1034,8 @@ void SetDefaultGameConfig(void)
     myConfig.ein_ctc3    = 0;                           // Default is normal CTC3 handling for Einstein (no fudge factor)
     myConfig.cvMode      = CV_MODE_NORMAL;              // Default is normal detect of Coleco Cart with possible SGM
     myConfig.soundDriver = SND_DRV_NORMAL;              // Default is normal sound driver (not Wave Direct)
-    myConfig.reserved3   = 0;
-    myConfig.reserved4   = 0;
+    myConfig.vdpRender   = VDP_RENDER_LINE;             // Default is to render each scanline as the beam passes
+    myConfig.soundRender = SND_RENDER_OVERSAMPLE;       // Default is to oversample the SN/AY chips (more CPU but the classic sound)
     myConfig.reserved5   = 0;
     myConfig.reserved6   = 0;
     myConfig.reserved7   = 0;
@@ -1491,8 +1491,8 @@ const struct options_t Option_Table[3][20] =
     // Page 1
     {
         {"OVERLAY",        {"GENERIC", "FULL KEYBOARD", "ALPHA KEYBOARD", "WARGAMES", "MOUSETRAP", "GATEWAY", "SPY HUNTER", "FIX UP MIX UP", "BOULDER DASH", "QUINTA ROO", "2010", "SPACE SHUTTLE", "UTOPIA", "BLACKJACK", "WAR ROOM"}, &myConfig.overlay,  15},
-        {"FRAME SKIP",     {"OFF", "SHOW 3/4", "SHOW 1/2"},                                                                                                                                     &myConfig.frameSkip,  3},
-        {"FRAME BLEND",    {"OFF", "ON"},                                                                                                                                                       &myConfig.frameBlend, 2},
+        {"FRAME SKIP",     {"OFF", "SHOW 3/4", "SHOW 1/2", "AUTO"},                                                                                                                             &myConfig.frameSkip,  4},
+        {"FRAME BLEND",    {"OFF", "ON", "DS LAYERS"},                                                                                                                                          &myConfig.frameBlend, 3},
         {"VIDEO TYPE",     {"NTSC", "PAL"},                                                                                                                                                     &myConfig.isPAL,      2},
         {"MAX SPRITES",    {"32",  "4"},                                                                                                                                                        &myConfig.maxSprites, 2},
         {"VERT SYNC",      {"OFF", "ON"},                                                                                                                                                       &myConfig.vertSync,   2},
@@ -1521,6 +1521,8 @@ const struct options_t Option_Table[3][20] =
                             "+20 (SLOWER)", "-1 (FASTER)", "-2 (FASTER)", "-3 (FASTER)", "-5 (FASTER)", "-10 (FASTER)", "-20 (FASTER)"},                                                        &myConfig.ein_ctc3,  13},
         {"ADAM EXTMEM",    {"MAX (1MB)", "512K", "256K", "128K", "64K"},                                                                                                                        &myConfig.adamMemory, 5},
         {"ADAMNET",        {"FAST", "SLOWER", "SLOWEST"},                                                                                                                                       &myConfig.adamnet,    3},
+        {"VDP RENDER",     {"LINE BY LINE", "DEFERRED"},                                                                                                                                        &myConfig.vdpRender,  2},
+        {"SOUND RENDER",   {"OVERSAMPLED", "BAND-LIMITED"},                                                                                                                                     &myConfig.soundRender, 2},
         {NULL,             {"",      ""},                                                                                                                                                       NULL,                 1},
     },
     // Global Options
@@ -1660,6 +1662,9 @@ void colecoDSGameOptions(bool bIsGlobal)
     // We can't support PAL with Vertical Sync
     if (myConfig.isPAL) myConfig.vertSync = 0;
 
+    // Options like MAX SPRITES change the picture without any VDP write - show the next frames
+    vdp_dirty = VDP_DIRTY_FRAMES;
+
     return;
 }
 
@@ -1946,6 +1951,25 @@ void CheckRomHeaders(char *szGame)
 }
 
 
+/*********************************************************************************
+ * A ROM bigger than ROM_Memory[] leaves the tail end of the file in the buffer
+ * after the CRC pass. Read back the first len bytes (on top of what was already
+ * put back) so the header checks and the MSX mapper guess see the start of the
+ * cart. Only carts that need it pay for this - most oversized files never do.
+ ********************************************************************************/
+static u32 rom_start_len = 0;
+static void ReloadRomStart(u32 len)
+{
+    if ((file_size <= (MAX_CART_SIZE * 1024)) || (len <= rom_start_len)) return;
+
+    FILE* handle = fopen(gpFic[ucGameChoice].szName, "rb");
+    if (handle == NULL) return;
+    fseek(handle, rom_start_len, SEEK_SET);
+    fread(ROM_Memory + rom_start_len, 1, len - rom_start_len, handle);
+    fclose(handle);
+    rom_start_len = len;
+}
+
 void ReadFileCRCAndConfig(void)
 {
     u8 checkCOM = 0;
@@ -1974,6 +1998,7 @@ void ReadFileCRCAndConfig(void)
 
     // Grab the all-important file CRC - this also loads the file into ROM_Memory[]
     getfile_crc(gpFic[ucGameChoice].szName);
+    rom_start_len = 0;
 
     if (strstr(gpFic[ucGameChoice].szName, ".sg")  != 0) sg1000_mode = 1;   // SG-1000 mode
     if (strstr(gpFic[ucGameChoice].szName, ".SG")  != 0) sg1000_mode = 1;   // SG-1000 mode
@@ -2015,7 +2040,9 @@ void ReadFileCRCAndConfig(void)
     if (strstr(gpFic[ucGameChoice].szName, ".col") != 0) checkROM = 1;  // Coleco types - check if MSX or SVI
     if (strstr(gpFic[ucGameChoice].szName, ".COL") != 0) checkROM = 1;  // Coleco types - check if MSX or SVI
 
+    if (checkROM) ReloadRomStart(0x4010);                       // The headers are all in the first 16K (plus the 2nd header)
     if (checkROM) CheckRomHeaders(gpFic[ucGameChoice].szName);   // See if we've got an MSX or SVI cart - this may set msx_mode=1 or svi_mode=2
+    if (msx_mode == 1) ReloadRomStart(MAX_CART_SIZE * 1024);      // An MSX megaROM guesses its mapper from the whole first chunk
 
     if (checkCOM)   // COM is usually Einstein... but we also support it for MTX for some games
     {
@@ -31,6 +31,10 @@
 #define CPU_CLEAR_INT_ON_VDP_READ   0
 #define CPU_CLEAR_INT_AUTOMATICALLY 1
 
+#define FRAME_BLEND_OFF             0
+#define FRAME_BLEND_CPU             1
+#define FRAME_BLEND_LAYERS          2
+
 #define COLECO_RAM_NO_MIRROR        0
 #define COLECO_RAM_NORMAL_MIRROR    1
 
@@ -61,6 +65,14 @@
 #define SND_DRV_NORMAL              0
 #define SND_DRV_WAVE                1
 
+#define FRAME_SKIP_AUTO             3
+
+#define VDP_RENDER_LINE             0
+#define VDP_RENDER_DEFERRED         1
+
+#define SND_RENDER_OVERSAMPLE       0
+#define SND_RENDER_BLEP             1
+
 typedef struct {
   char szName[MAX_ROM_NAME+1];
   u8 uType;
@@ -124,8 +136,8 @@ struct __attribute__((__packed__)) Config_t
     u8  ein_ctc3;
     u8  cvMode;
     u8  soundDriver;
-    u8  reserved3;
-    u8  reserved4;
+    u8  vdpRender;
+    u8  soundRender;
     u8  reserved5;
     u8  reserved6;
     u8  reserved7;
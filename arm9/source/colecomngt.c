@@ -27,6 +27,7 @@
 #include "colecomngt.h"
 #include "colecogeneric.h"
 #include "MTX_BIOS.h"
+#include "pagedrom.h"
 
 // ------------------------------------------------
 // Adam RAM is 128K (64K Intrinsic, 64K Expanded)
@@ -34,7 +35,7 @@
 // ------------------------------------------------
 u8 adam_ext_ram_used   = 0;
 u8 sg1000_double_reset = false;
-u8 bSuperSimplifiedMemory = 0;
+u8 bSuperSimplifiedMemory = 0;     // 1 = simplified driver with a flat 64K, 2 = the same but with the Mega Cart window banked by pointer
 
 // -----------------------------------------------------------------------
 // Used by various systems such as the ADAM and MSX to point to
@@ -505,53 +506,6 @@ void colecoSetPal(void)
 }
 
 
-/*********************************************************************************
- * Update the screen for the current cycle. On the DSi this will generally
- * be called right after swiWaitForVBlank() in TMS9918a.c which will help
- * reduce visual tearing and other artifacts. It's not strictly necessary
- * and that does slow down the loop a bit... but DSi can handle it.
- ********************************************************************************/
-ITCM_CODE void colecoUpdateScreen(void)
-{
-    // ------------------------------------------------------------
-    // If we are in 'blendMode' we will OR the last two frames.
-    // This helps on some games where things are just 1 pixel
-    // wide and the non XL/LL DSi will just not hold onto the
-    // image long enough to render it properly for the eye to
-    // pick up. This takes CPU speed, however, and will not be
-    // supported for older DS-LITE/PHAT units with slower CPU.
-    // ------------------------------------------------------------
-    if (myConfig.frameBlend)
-    {
-      if (XBuf == XBuf_A)
-      {
-          XBuf = XBuf_B;
-      }
-      else
-      {
-          XBuf = XBuf_A;
-
-          // Because we are OR-ing two frames together, we only need to blend every other frame...
-          u32 *p1 = (u32*)XBuf_A;
-          u32 *p2 = (u32*)XBuf_B;
-          u32 *destP = (u32*)pVidFlipBuf;
-
-          for (u16 i=0; i<(256*192)/4; i++)
-          {
-              *destP++ = (*p1++ | *p2++);       // Simple OR blending of 2 frames...
-          }
-      }
-    }
-    else
-    {
-        // -----------------------------------------------------------------
-        // Not blend mode... just blast it out via DMA as fast as we can...
-        // -----------------------------------------------------------------
-        dmaCopyWordsAsynch(2, (u32*)XBuf_A, (u32*)pVidFlipBuf, 256*192);
-    }
-}
-
-
 /*******************************************************************************
  * Compute the file CRC - this will be our unique identifier for the game
  * for saving HI SCORES and Configuration / Key Mapping data.
@@ -616,6 +570,8 @@ u8 loadrom(const char *filename, u8 * ptr)
     bActivisionPCB = 0;         // No Activision PCB
     bSuperGameCart = 0;         // No Super Game Cart (aka MegaCart2)
     b31_in_1 = 0;               // No 31-in-1 Cart
+    Mega31in1CacheClose();      // And no 31-in-1 bank cache file held open
+    PagedROMClose();            // And no demand-paged ROM
 
     // ----------------------------------------------------------------------
     // Look for the Survivors .sc Multicart  (2MB!) or .sc MegaCart (4MB!)
@@ -644,20 +600,20 @@ u8 loadrom(const char *filename, u8 * ptr)
     else if (myConfig.cvMode == CV_MODE_31IN1) // These are special 32K mappers for large 31-in-1 or 63-in-1 carts
     {
         b31_in_1 = 1;
-        fseek(handle, romSize-0x8000, SEEK_SET);              // Seek to the last 32K block (this is the menu system)
-        fread((void*) RAM_Memory+0x8000, 1, 0x8000, handle);  // Read 32K from that last block directly into the RAM buffer
         fclose(handle);
         strcpy(disk_last_file[0], filename);
         strcpy(disk_last_path[0], initial_path);
         romBankMask = (romSize == (1024 * 1024) ? 0x1F:0x3F);
+        Mega31in1CacheInit();                                 // Bank cache holds on to the file from here on
+        Mega31in1BankSwitch((romSize / 0x8000) - 1);          // The last 32K block is the menu system
         bIsComplicatedRAM = true;
         machine_mode = MODE_COLECO;
         return 1;
     }
     else
-    if (romSize <= (MAX_CART_SIZE * 1024))  // Max size cart is 1MB/4MB - that's pretty huge...
+    if ((romSize <= (MAX_CART_SIZE * 1024)) || PagedROMInit(filename, romSize))  // Max size cart is 1MB/4MB - bigger MSX megaROMs are paged in from the file
     {
-        fclose(handle); // We only need to close the file - the game ROM is now sitting in ROM_Memory[] from the getFileCrc() handler
+        fclose(handle); // We only need to close the file - the game ROM is now sitting in ROM_Memory[] from the getFileCrc() handler (or is paged)
 
         romBankMask = 0x00;         // No bank mask until proven otherwise
         mapperMask = 0x00;          // No MSX mapper mask
@@ -915,6 +871,13 @@ u8 loadrom(const char *filename, u8 * ptr)
       
       // If the user has enabled mirrors, we can't use the simplified driver
       if (myConfig.mirrorRAM) bSuperSimplifiedMemory = 0;
+
+      // Mega Carts use the variant that reads the bank at 0xC000 through a pointer - no 16K copy per bank switch
+      if (bSuperSimplifiedMemory && bMagicMegaCart)
+      {
+          bSuperSimplifiedMemory = 2;
+          simplified_bank = ((last_mega_bank < 16) ? (fastROM + ((u32)last_mega_bank * (u32)0x4000)) : MemoryMap[6]);
+      }
   }
   
   return bOK;
@@ -1117,7 +1080,7 @@ ITCM_CODE unsigned char cpu_readport16(register unsigned short Port)
   // Port 52 is used for the AY sound chip for the Super Game Module
   if (Port == 0x52)
   {
-      return ay38910DataR(&myAY);
+      return SoundReadAY();
   }
 
   switch(Port&0xE0)
@@ -1189,7 +1152,7 @@ ITCM_CODE void cpu_writeport16(register unsigned short Port,register unsigned ch
       JoyMode=JOYMODE_KEYPAD;
       return;
     case 0xE0:  // Ports E0-FF: The SN Sound port
-      sn76496W(Value, &mySN);
+      SoundWriteSN(Value);
       return;
     case 0xA0: // We know it's a VDP control write as data writes are trapped above
       if (WrCtrl9918(Value)) { CPU.IRequest=INT_NMI;}
@@ -1208,7 +1171,7 @@ ITCM_CODE void cpu_writeport16(register unsigned short Port,register unsigned ch
       // -----------------------------------------------
       else if (Port == 0x51)
       {
-        ay38910DataW(Value, &myAY);
+        SoundWriteAY(Value);
       }
       // -----------------------------------------------
       // Port 42 is the Expanded Memory for the ADAM
@@ -1241,6 +1204,31 @@ ITCM_CODE void cpu_writeport16(register unsigned short Port,register unsigned ch
 }
 
 
+// -------------------------------------------------------------------------
+// Returns 1 if a write to this port would go straight to WrData9918() for
+// the machine being emulated. This mirrors the port decoding done in the
+// various cpu_writeport handlers and lets the Z80 core burst OTIR loops
+// into VRAM with WrBlock9918(). The PV-1000 has no TMS9918 and the PV-2000
+// VDP is memory mapped so neither ever takes the burst path.
+// -------------------------------------------------------------------------
+ITCM_CODE u8 IsVDPDataPort(register unsigned short Port)
+{
+  if (machine_mode & (MODE_MSX | MODE_SG_1000 | MODE_SORDM5 | MODE_PV1000 | MODE_PV2000 | MODE_MEMOTECH | MODE_SVI | MODE_EINSTEIN))
+  {
+      Port &= 0x00FF;
+      if (machine_mode & MODE_MSX)      return (Port == 0x98);
+      if (machine_mode & MODE_SG_1000)  return ((Port >= 0x80) && (Port < 0xD0) && ((Port & 1) == 0));
+      if (machine_mode & MODE_SORDM5)   return (((Port & 0xF7) >= 0x10) && ((Port & 0xF7) < 0x20) && ((Port & 1) == 0));
+      if (machine_mode & MODE_MEMOTECH) return (Port == 0x01);
+      if (machine_mode & MODE_SVI)      return (Port == 0x80);
+      if (machine_mode & MODE_EINSTEIN) return (((Port & 0xF8) == 0x08) && ((Port & 1) == 0));
+      return 0;
+  }
+
+  return ((Port&0xE1) == 0xA0);
+}
+
+
 // -------------------------------------------------------------------------
 // For arious machines, we have patched the BIOS so that we trap calls
 // to various I/O routines: namely cassette access. We handle that here.
@@ -1314,7 +1302,8 @@ ITCM_CODE u32 LoopZ80()
 
       // Execute 1 scanline worth of CPU instructions
       u32 cycles_to_process = tms_cpu_line + CPU.CycleDeficit;
-      if (bSuperSimplifiedMemory) CPU.CycleDeficit = ExecZ80_Simplified(cycles_to_process);
+      if (bSuperSimplifiedMemory == 2) CPU.CycleDeficit = ExecZ80_SimplifiedBanked(cycles_to_process);
+      else if (bSuperSimplifiedMemory) CPU.CycleDeficit = ExecZ80_Simplified(cycles_to_process);
       else CPU.CycleDeficit = ExecZ80(cycles_to_process);
       
 
@@ -1366,18 +1355,7 @@ ITCM_CODE u32 LoopZ80()
   // Drop out unless end of screen is reached
   if (CurLine == tms_end_line)
   {
-      // ------------------------------------------------------------------------------------
-      // If the MSX Beeper is being used (rare but a few of the ZX Spectrum ports use it),
-      // then we need to service it here. We basically track the frequency at which the
-      // game has hit the beeper and approximate that by using AY Channel A to produce the
-      // tone.  This is crude and doesn't sound quite right... but good enough.
-      // ------------------------------------------------------------------------------------
-      if (myConfig.msxBeeper)
-      {
-          if (msx_mode) MSX_HandleBeeper();
-          else if (einstein_mode) einstein_HandleBeeper();
-      }
-      else if (adam_mode)
+      if (adam_mode)
       {
           adam_drive_cache_check();    // Make sure the disk and tape buffers are up to date
       }
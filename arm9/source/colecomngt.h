@@ -48,6 +48,7 @@ extern u8 msx_kana_lock;
 extern u32 MAX_CART_SIZE;
 
 extern u8 bSuperSimplifiedMemory;
+extern u8 *simplified_bank;
 
 extern u8 *ROM_Memory;
 extern u8 RAM_Memory[0x10000];
@@ -86,6 +87,8 @@ extern u8 msx_sram_enabled;
 extern u8 sgm_enable;
 extern u8 AY_Enable;
 extern u8 last_mega_bank; 
+extern u32 bank_cache_hits;
+extern u32 bank_cache_misses;
 extern u16 msx_block_size;
 extern u32 file_crc;
 extern u8 ctc_enabled;
@@ -160,6 +163,7 @@ extern uint8_t  pv1000_bd_color;
 extern uint16_t pv1000_freqA;
 extern uint16_t pv1000_freqB;
 extern uint16_t pv1000_freqC;
+extern uint8_t  pv1000_redraw_all;
 
 
 // --------------------------------------------------
@@ -197,6 +201,7 @@ extern u8 MSXBios_CasioPV7[];
 extern u8 colecoInit(char *szGame);
 extern void colecoSetPal(void);
 extern void colecoUpdateScreen(void);
+extern void colecoBlendWords(u32 *p1, u32 *p2, u32 *destP, u32 words);
 extern void colecoKeyProc(void);
 extern void colecoRun(void);
 extern void getfile_crc(const char *path);
@@ -219,8 +224,6 @@ extern u32  pv1000_run(void);
 extern void pv2000_reset(void);
 extern void msx_reset(void);
 extern void msx_restore_bios(void);
-extern void MSX_HandleBeeper(void);
-extern void einstein_HandleBeeper(void);
 extern void einstein_handle_interrupts(void);
 extern void einstein_load_com_file(void);
 extern void einstien_load_dsk_file(void);
@@ -238,6 +241,10 @@ extern u8 loadrom(const char *path,u8 * ptr);
 extern u32 LoopZ80();
 extern void MegaCartBankSwitch(u8 bank);
 extern void MegaCartBankSwap(u8 bank);
+extern void Mega31in1BankSwitch(u8 bank);
+extern void Mega31in1CacheInit(void);
+extern void Mega31in1CacheClose(void);
+extern void Mega31in1Prefetch(void);
 extern void BufferKey(u8 key);
 extern void BufferKeys(char *str);
 
@@ -263,8 +270,6 @@ extern u8   SuperGameCartRead(u16 address);
 extern void SuperGameCartSaveFlash(void);
 extern u8   IsSuperGameCart(u32 crc);
 
-extern void BeeperON(u16 beeper_freq);
-extern void BeeperOFF(void);
 
 extern void Z80_Interface_Reset(void);
 
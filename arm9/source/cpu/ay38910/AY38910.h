@@ -85,6 +85,15 @@ int ay38910GetStateSize(void);
  */
 void ay38910Mixer(int count, s16 *dest, AY38910 *chip);
 
+/**
+ * Renders count amount of samples like ay38910Mixer but at the output rate,
+ * with band-limited steps instead of oversampling (see AY38910_BL.c).
+ * @param  count: Number of samples to render.
+ * @param  *dest: Pointer to buffer where sound is rendered.
+ * @param  *chip: The AY38910 chip.
+ */
+void ay38910MixerBL(int count, s16 *dest, AY38910 *chip);
+
 /**
  * Write index/register value to the AY38910 chip
  * @param  index: index to write.
@@ -0,0 +1,180 @@
+//
+//  AY38910_BL.c
+//  Band-limited renderer for the AY-3-8910 / YM2149 sound chip emulator.
+//
+//  ay38910Mixer() clocks the chip AY_UPSHIFT times per output sample and low
+//  pass filters the result to keep the aliasing down. This renders from the
+//  same AY38910 struct at the output rate instead - the tone, noise and
+//  envelope counters each add a whole sample worth of counting and every step
+//  in the output is smoothed over the two neighbouring samples with a
+//  polynomial band-limited step (polyBLEP). Either renderer can be used at any
+//  time as both keep the chip state the same way.
+//
+#include <nds.h>
+
+#include "AY38910.h"
+
+#ifdef AY_UPSHIFT
+    #define USHIFT  AY_UPSHIFT
+#else
+    #define USHIFT  0
+#endif
+#ifdef AYFILTER
+    #define FSHIFT  (AYFILTER+USHIFT)
+#else
+    #define FSHIFT  (1+USHIFT)
+#endif
+
+#define WFEED       0x12000             // White Noise Feedback, according to MAME.
+
+#define AY_TONE_STEP    (0x0010 << USHIFT)      // Counter units per output sample
+#define AY_NOISE_STEP   (0x0800 << USHIFT)
+#define AY_ENV_STEP     (0x0001 << USHIFT)
+
+// ---------------------------------------------------------------------------------------
+// The level we last output (before the BLEP correction) and the correction still owed
+// to the next sample. These live outside the AY38910 struct so the saved state is the
+// same whichever renderer is used.
+// ---------------------------------------------------------------------------------------
+static s32 blepLevel __attribute__((section(".dtcm"))) = 0;
+static s32 blepCarry __attribute__((section(".dtcm"))) = 0;
+
+// ---------------------------------------------------------------------------------------
+// A step of 'delta' that happened 'frac' (1/256ths of a sample) before the end of the
+// sample interval. The sample before the step is pulled towards the new level and the
+// sample after it back towards the old one - the two halves of the polyBLEP residual.
+// ---------------------------------------------------------------------------------------
+static inline __attribute__((always_inline)) void blepStep(s32 delta, u32 frac, s32 *before)
+{
+    u32 early = 256 - frac;
+    *before   += (delta * (s32)((frac*frac) >> 9)) >> 8;
+    blepCarry -= (delta * (s32)((early*early) >> 9)) >> 8;
+}
+
+// ---------------------------------------------------------------------------------------
+// The output level for a chip state - the same sum the oversampled mixer adds each clock.
+// The state word is packed exactly as ay38910Mixer() packs it (see AY38910_C.c).
+// ---------------------------------------------------------------------------------------
+static inline __attribute__((always_inline)) s32 ayLevel(u32 state, const s32 *vol, const u32 *att)
+{
+    u32 on = state | (state >> 10);     // Channels disable.
+    on &= on >> 3;                      // Noise disable.
+    on &= 0x07;
+
+    s32 level = 0;
+    if (on & 1) level += vol[0];
+    if (on & 2) level += vol[1];
+    if (on & 4) level += vol[2];
+
+    on &= (state >> 7);                 // Channels that use the envelope
+    if (on)
+    {
+        u32 env = state & 0x78000000;
+        if (!((((state >> 31) & (state >> 17)) ^ (state >> 18)) & 1)) env ^= 0x78000000;
+        s32 envVol = att[env >> 27];
+        if (on & 1) level += envVol;
+        if (on & 2) level += envVol;
+        if (on & 4) level += envVol;
+    }
+    return level;
+}
+
+ITCM_CODE void ay38910MixerBL(int count, s16 *dest, AY38910 *chip)
+{
+    const u32 *att = (const u32 *)chip->ayEnvVolumePtr;
+    u32 cnt[3], frq[3];
+    s32 vol[3];
+    u32 noiseCnt = chip->ch3Addr;
+    u32 noiseFrq = (chip->ch3Freq & 0x1F) << 11;
+    u32 envCnt = chip->ayEnvFreq >> 16;
+    u32 envFrq = chip->ayEnvFreq & 0xFFFF;
+    u32 envReload = (envFrq ? envFrq : 0x10000);        // A zero reload leaves the 16-bit counter where it wrapped to
+    if (!noiseFrq) noiseFrq = 0x10000;
+    u32 rng = chip->ayRng;
+    u32 state = chip->ayChState | (chip->ayChDisable << 8) | (chip->ayEnvType << 16) | ((u32)chip->ayEnvAddr << 24);
+
+    for (int ch=0; ch<3; ch++)
+    {
+        u8 reg = chip->ayRegs[8+ch];
+        cnt[ch] = (&chip->ch0Addr)[ch<<1];
+        frq[ch] = ((&chip->ch0Freq)[ch<<1] & 0xFFF) << 4;
+        if (!frq[ch]) frq[ch] = 0x10000;
+        vol[ch] = (reg ? att[reg & 0x1F] : 0);      // Zero when the channel uses the envelope
+        state &= ~(0x0080 << ch);
+        if (reg & 0x10) state |= (0x0080 << ch);
+    }
+    if ((state & 0x80000000) && (state & 0x00010000)) state &= ~0x78000000;     // Envelope Hold
+
+    s32 level = blepLevel;
+    s32 now = ayLevel(state, vol, att);
+
+    while (count-- > 0)
+    {
+        s32 out = level + blepCarry;
+        blepCarry = 0;
+
+        if (now != level)                           // A register was written - step right at the start of this sample
+        {
+            blepStep(now - level, 256, &out);
+            level = now;
+        }
+
+        for (int ch=0; ch<3; ch++)                  // Tone channels A,B,C
+        {
+            u32 c = cnt[ch] + AY_TONE_STEP;
+            while (c >= 0x10000)
+            {
+                u32 frac = ((c - 0x10000) << 8) / AY_TONE_STEP;
+                state ^= (1 << ch);
+                now = ayLevel(state, vol, att);
+                if (now != level) {blepStep(now - level, frac, &out); level = now;}
+                c -= frq[ch];
+            }
+            cnt[ch] = c;
+        }
+
+        u32 c = noiseCnt + AY_NOISE_STEP;           // Noise
+        while (c >= 0x10000)
+        {
+            u32 frac = ((c - 0x10000) << 8) / AY_NOISE_STEP;
+            state |= 0x38;
+            if (rng & 1)
+            {
+                rng = (rng >> 1) ^ WFEED;
+                state ^= 0x38;
+            }
+            else rng >>= 1;
+            now = ayLevel(state, vol, att);
+            if (now != level) {blepStep(now - level, frac, &out); level = now;}
+            c -= noiseFrq;
+        }
+        noiseCnt = c;
+
+        c = envCnt + AY_ENV_STEP;                   // Envelope
+        while (c >= 0x10000)
+        {
+            u32 frac = ((c - 0x10000) << 8) / AY_ENV_STEP;
+            state += 0x08000000;
+            if ((state & 0x80000000) && (state & 0x00010000)) state &= ~0x78000000;
+            now = ayLevel(state, vol, att);
+            if (now != level) {blepStep(now - level, frac, &out); level = now;}
+            c -= envReload;
+        }
+        envCnt = c;
+
+        if (out < 0) out = 0;
+        else if (out > 0xFFFF) out = 0xFFFF;
+        *dest++ = (s16)(out ^ 0x8000);
+    }
+
+    for (int ch=0; ch<3; ch++) (&chip->ch0Addr)[ch<<1] = cnt[ch];
+    chip->ch3Addr = noiseCnt;
+    chip->ayRng = rng;
+    chip->ayEnvFreq = (envCnt << 16) | envFrq;
+    chip->ayChState = state;
+    chip->ayChDisable = state >> 8;
+    chip->ayEnvType = state >> 16;
+    chip->ayEnvAddr = state >> 24;
+    chip->ayOldSample = (u32)level << FSHIFT;       // So the oversampled mixer carries on from the same level
+    blepLevel = level;
+}
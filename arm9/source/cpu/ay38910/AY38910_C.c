@@ -0,0 +1,292 @@
+//
+//  AY38910_C.c
+//  Portable C version of the AY-3-8910 / YM2149 sound chip emulator.
+//
+//  This follows AY38910.s (Fredrik Ahlström, 2006-2024) step for step so that
+//  both produce the same samples from the same register writes. It uses the
+//  same AY38910 struct and API - build with SOUND_C_CORES (or for anything that
+//  isn't ARM) to use this in place of the assembly version.
+//
+#include <nds.h>
+#include <string.h>
+
+#include "AY38910.h"
+
+#if !defined(__arm__) || defined(SOUND_C_CORES)
+
+#define NSEED       0x10000             // Noise Seed
+#define WFEED       0x12000             // White Noise Feedback, according to MAME.
+#define WFEED3      0x14000             // White Noise Feedback for AY-3-8930, according to MAME.
+
+#ifdef AY_UPSHIFT
+    #define USHIFT  AY_UPSHIFT
+#else
+    #define USHIFT  0
+#endif
+#ifdef AYFILTER
+    #define FSHIFT  (AYFILTER+USHIFT)
+#else
+    #define FSHIFT  (1+USHIFT)
+#endif
+
+#define AYNOISEADD  0x08000000
+#define AYTONEADD   0x00100000
+#define AYENVADD    0x00010000
+
+// ---------------------------------------------------------------------------------------
+// The 32-bit word starting at ayChState is worked on as a whole, as in the assembly:
+//   bits  0-2   tone output of channels A,B,C       bits  3-5   noise output (all three)
+//   bits  7-9   channel A,B,C volume uses envelope   bits 10-15  register 7 tone/noise disables
+//   bits 16-19  envelope hold,alternate^hold,attack,continue
+//   bits 27-30  envelope step                        bit  31     envelope has completed a cycle
+// ---------------------------------------------------------------------------------------
+typedef void (*tAYPortOut)(u8 value, AY38910 *chip);
+typedef u8   (*tAYPortIn)(AY38910 *chip);
+
+static const u32 attenuation[32] __attribute__((aligned(4))) =   // each step * 0.70710678 (-3dB?)
+{
+    0x0000, 0x00AB, 0x00F1, 0x0155, 0x01E3, 0x02AB, 0x03C5, 0x0555,
+    0x078B, 0x0AAB, 0x0F16, 0x1555, 0x1E2B, 0x2AAB, 0x3C57, 0x5555,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000
+};
+
+static const u8 regMask[16] = {0xFF,0x0F,0xFF,0x0F,0xFF,0x0F,0x1F,0xFF, 0x1F,0x1F,0x1F,0xFF,0xFF,0x0F,0xFF,0xFF};
+
+static void dummyOutFunc(u8 value, AY38910 *chip) {}
+static u8 portAInDummy(AY38910 *chip) {return chip->ayPortAIn;}
+static u8 portBInDummy(AY38910 *chip) {return chip->ayPortBIn;}
+
+// ---------------------------------------------------------------------------------------
+// Build the 8 possible mixes of the three channels being high or low and flag which
+// channels take their volume from the envelope instead.
+// ---------------------------------------------------------------------------------------
+static u32 calculateVolumes(AY38910 *chip, u32 state)
+{
+    const u32 *att = (const u32 *)chip->ayEnvVolumePtr;
+    u32 vol[3];
+
+    state &= ~0x0380;                   // Bits used to show which channels use the envelope.
+    for (int ch=0; ch<3; ch++)
+    {
+        u8 reg = chip->ayRegs[8+ch];
+        vol[ch] = (reg ? att[reg & 0x1F] : 0);
+        if (reg & 0x10) state |= (0x0080 << ch);
+    }
+
+    for (int i=7; i>0; i--)             // Entry 0 (all channels low) stays at zero
+    {
+        u32 v = (i & 1) ? vol[0] : 0;
+        if (i & 4) v += vol[2];
+        if (i & 2) v += vol[1];
+        chip->ayCalculatedVolumes[i] = (s16)v;
+    }
+    chip->ayAttChg = 0;
+
+    return state;
+}
+
+ITCM_CODE void ay38910Mixer(int count, s16 *dest, AY38910 *chip)
+{
+    u32 ch0 = chip->ch0Freq | ((u32)chip->ch0Addr << 16);
+    u32 ch1 = chip->ch1Freq | ((u32)chip->ch1Addr << 16);
+    u32 ch2 = chip->ch2Freq | ((u32)chip->ch2Addr << 16);
+    u32 ch3 = chip->ch3Freq | ((u32)chip->ch3Addr << 16);
+    u32 rng = chip->ayRng;
+    u32 envFreq = chip->ayEnvFreq;
+    u32 state = chip->ayChState | (chip->ayChDisable << 8) | (chip->ayEnvType << 16) | ((u32)chip->ayEnvAddr << 24);
+    u32 mix = chip->ayOldSample;
+    const u32 *att = (const u32 *)chip->ayEnvVolumePtr;
+    u32 t, on, env, envVol;
+
+    if (chip->ayAttChg) state = calculateVolumes(chip, state);
+
+    count <<= USHIFT;
+    do
+    {
+        mix -= mix >> (FSHIFT-USHIFT);
+        do
+        {
+            t = ch0 + AYTONEADD; if (t < ch0) {t -= t << 20; state ^= 0x01;} ch0 = t;     // Channel A
+            t = ch1 + AYTONEADD; if (t < ch1) {t -= t << 20; state ^= 0x02;} ch1 = t;     // Channel B
+            t = ch2 + AYTONEADD; if (t < ch2) {t -= t << 20; state ^= 0x04;} ch2 = t;     // Channel C
+
+            t = ch3 + AYNOISEADD;
+            if (t < ch3)
+            {
+                t -= t << 27;
+                state |= 0x38;          // Clear noise channel.
+                if (rng & 1)
+                {
+                    rng = (rng >> 1) ^ WFEED;
+                    state ^= 0x38;      // Noise channel.
+                }
+                else rng >>= 1;
+            }
+            ch3 = t;
+
+            t = envFreq + AYENVADD;
+            if (t < envFreq)
+            {
+                t -= t << 16;
+                state += 0x08000000;
+            }
+            envFreq = t;
+            if ((state & 0x80000000) && (state & 0x00010000)) state &= ~0x78000000;     // Envelope Hold
+
+            on = state | (state >> 10);     // Channels disable.
+            on &= on >> 3;                  // Noise disable.
+            on &= 0x07;
+            mix += (u16)chip->ayCalculatedVolumes[on];
+
+            // Envelope Alternate (already flipped from Hold) and Attack decide the direction of the step
+            env = state & 0x78000000;
+            if (!((((state >> 31) & (state >> 17)) ^ (state >> 18)) & 1)) env ^= 0x78000000;
+
+            on &= (state >> 7);             // Check if any channels use envelope
+            if (on)
+            {
+                envVol = att[env >> 27];
+                if (on & 4) mix += envVol;
+                if (on & 2) mix += envVol;
+                if (on & 1) mix += envVol;
+            }
+
+            count--;
+#if USHIFT
+        } while (count & ((1<<USHIFT)-1));
+#else
+        } while (0);
+#endif
+        if (count >= 0) *dest++ = (s16)((mix >> FSHIFT) ^ 0x8000);
+    } while (count > 0);
+
+    chip->ch0Addr = ch0 >> 16;
+    chip->ch1Addr = ch1 >> 16;
+    chip->ch2Addr = ch2 >> 16;
+    chip->ch3Addr = ch3 >> 16;
+    chip->ayRng = rng;
+    chip->ayEnvFreq = envFreq;
+    chip->ayChState = state;
+    chip->ayChDisable = state >> 8;
+    chip->ayEnvType = state >> 16;
+    chip->ayEnvAddr = state >> 24;
+    chip->ayOldSample = mix;
+}
+
+static void updateAllRegisters(AY38910 *chip)
+{
+    for (u8 reg=0; reg<0x10; reg++)
+    {
+        ay38910IndexW(reg, chip);
+        ay38910DataW(chip->ayRegs[reg], chip);
+    }
+}
+
+void ay38910Reset(AY38910 *chip)
+{
+    memset(chip, 0x00, sizeof(AY38910));    // Clear AY38910 state
+
+    updateAllRegisters(chip);
+
+    chip->ayEnvVolumePtr = (u16 *)attenuation;
+    chip->ayPortAOutFptr = (void *)dummyOutFunc;
+    chip->ayPortBOutFptr = (void *)dummyOutFunc;
+    chip->ayPortAInFptr  = (void *)portAInDummy;
+    chip->ayPortBInFptr  = (void *)portBInDummy;
+
+    chip->ayPortAIn = 0xFF;
+    chip->ayPortBIn = 0xFF;
+    chip->ayRng = NSEED;
+}
+
+int ay38910SaveState(void *dest, const AY38910 *chip)
+{
+    memcpy(dest, chip->ayRegs, 0x10);
+    return 0x10;
+}
+
+int ay38910LoadState(AY38910 *chip, const void *source)
+{
+    memcpy(chip->ayRegs, source, 0x10);
+    updateAllRegisters(chip);
+    return 0x10;
+}
+
+int ay38910GetStateSize(void)
+{
+    return 0x10;
+}
+
+void ay38910IndexW(u8 index, AY38910 *chip)
+{
+    if (!(index & 0xF0)) chip->ayRegIndex = index;
+}
+
+void ay38910DataW(u8 value, AY38910 *chip)
+{
+    u8 reg = chip->ayRegIndex;
+    u16 freq;
+
+    value &= regMask[reg];
+    chip->ayRegs[reg] = value;
+
+    switch (reg)
+    {
+        case 0x1: case 0x3: case 0x5:   // Frequency coarse
+            reg &= ~1;
+            // fall through
+        case 0x0: case 0x2: case 0x4:   // Frequency fine
+            freq = chip->ayRegs[reg] | (chip->ayRegs[reg+1] << 8);
+            if (freq == 0) freq = 1;
+            (&chip->ch0Freq)[reg] = freq;
+            break;
+
+        case 0x6:                       // Frequency coarse noise
+            chip->ch3Freq = (value ? value : 1);
+            break;
+
+        case 0x7:                       // Channel disable
+            chip->ayChDisable = (chip->ayChDisable & 3) | (value << 2);     // Save top envelope enable bits.
+            break;
+
+        case 0x8: case 0x9: case 0xA:   // Attenuation
+            chip->ayAttChg = reg;
+            break;
+
+        case 0xB: case 0xC:             // Envelope frequency
+            freq = chip->ayRegs[0xB] | (chip->ayRegs[0xC] << 8);
+            if (freq == 0) freq = 1;
+            chip->ayEnvFreq = (chip->ayEnvFreq & 0xFFFF0000) | freq;
+            break;
+
+        case 0xD:                       // Envelope type
+            if (value < 4) value = 9;
+            else if (value < 8) value = 0xF;
+            if (value & 1) value ^= 2;  // ALT ^= Hold
+            chip->ayEnvType = value;
+            chip->ayEnvAddr = 0;        // Also clear Envelope addr
+            break;
+
+        case 0xE:
+            chip->ayPortAOut = value;
+            if (chip->ayRegs[7] & 0x40) ((tAYPortOut)chip->ayPortAOutFptr)(value, chip);
+            break;
+
+        case 0xF:
+            chip->ayPortBOut = value;
+            if (chip->ayRegs[7] & 0x80) ((tAYPortOut)chip->ayPortBOutFptr)(value, chip);
+            break;
+    }
+}
+
+u8 ay38910DataR(AY38910 *chip)
+{
+    u8 reg = chip->ayRegIndex;
+
+    if (reg == 0xE) return ((tAYPortIn)chip->ayPortAInFptr)(chip);
+    if (reg >  0xE) return ((tAYPortIn)chip->ayPortBInFptr)(chip);
+    return chip->ayRegs[reg];
+}
+
+#endif // !__arm__ || SOUND_C_CORES
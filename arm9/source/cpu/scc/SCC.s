@@ -5,7 +5,7 @@
 ;@  Created by Fredrik Ahlström on 2006-04-01.
 ;@  Copyright © 2006-2024 Fredrik Ahlström. All rights reserved.
 ;@
-#ifdef __arm__
+#if defined(__arm__) && !defined(SOUND_C_CORES)
 
 #include "SCC.i"
 
@@ -335,4 +335,4 @@ sccKeyOnW:
 	bx lr
 ;@----------------------------------------------------------------------------
 	.end
-#endif // #ifdef __arm__
+#endif // #if defined(__arm__) && !defined(SOUND_C_CORES)
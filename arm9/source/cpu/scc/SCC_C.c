@@ -0,0 +1,138 @@
+//
+//  SCC_C.c
+//  Portable C version of the Konami SCC/K051649 sound chip emulator.
+//
+//  This follows SCC.s (Fredrik Ahlström, 2006-2024) step for step so that
+//  both produce the same samples from the same register writes. It uses the
+//  same SCC struct and API - build with SOUND_C_CORES (or for anything that
+//  isn't ARM) to use this in place of the assembly version.
+//
+#include <nds.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "SCC.h"
+
+#if !defined(__arm__) || defined(SOUND_C_CORES)
+
+#if !defined(SCCMULT)
+    #define SCCMULT 16
+#endif
+#define SCCADDITION (0x00004000*SCCMULT)
+
+#define SCC_STATE_SIZE  (sizeof(SCC) - offsetof(SCC, ch0Wave))     // Wave RAM and registers - 148 bytes
+#define SCC_STATE(chip) ((u8 *)(chip) + offsetof(SCC, ch0Wave))    // Wave RAM 0x00-0x7F then registers 0x80-0x8F
+
+// ---------------------------------------------------------------------------------------
+// The assembly version patches the channel volumes straight into the mixer code so they
+// are not part of the SCC struct. We keep them here in fast DTCM instead - like the
+// patched code, they are only set by the volume registers and not by SCCReset().
+// ---------------------------------------------------------------------------------------
+static u8 sccVolume[5] __attribute__((section(".dtcm"))) = {0};
+
+static const u8 SCCVolume[16] = {0,3,7,10,14,17,20,24,27,31,34,37,41,44,48,51};
+
+// ---------------------------------------------------------------------------------------
+// Each channel counter word is laid out as (I=sample index, V=overflow, C=counter,
+// F=frequency):  IIIIIVCCCCCCCCCCCC10FFFFFFFFFFFF
+// ---------------------------------------------------------------------------------------
+ITCM_CODE void SCCMixer(int count, s16 *dest, SCC *chip)
+{
+    u32 ch[5];
+    const s8 *wave[5] = {chip->ch0Wave, chip->ch1Wave, chip->ch2Wave, chip->ch3Wave, chip->ch3Wave};  // Channel 4 uses the same waveform as channel 3
+    s32 mix;
+
+    for (int i=0; i<5; i++) ch[i] = (&chip->ch0Freq)[i<<1] | ((u32)(&chip->ch0Addr)[i<<1] << 16);
+
+    do
+    {
+        mix = 0;
+        for (int i=0; i<5; i++)
+        {
+            u32 c = ch[i] + SCCADDITION;
+            u32 index = c >> 27;
+            if (c & (1 << 26)) c -= (u32)(((s32)(c << 18)) >> 4);
+            ch[i] = c;
+            if (sccVolume[i]) mix += sccVolume[i] * wave[i][index];
+        }
+        count--;
+        if (count >= 0) *dest++ = (s16)mix;
+    } while (count > 0);
+
+    for (int i=0; i<5; i++)
+    {
+        (&chip->ch0Freq)[i<<1] = ch[i];
+        (&chip->ch0Addr)[i<<1] = ch[i] >> 16;
+    }
+}
+
+void SCCReset(SCC *chip)
+{
+    memset(chip, 0x00, sizeof(SCC));    // clear variables
+    chip->ch0Freq = 0x2000;             // counters
+    chip->ch1Freq = 0x2000;
+    chip->ch2Freq = 0x2000;
+    chip->ch3Freq = 0x2000;
+    chip->ch4Freq = 0x2000;
+}
+
+int SCCSaveState(void *destination, const SCC *chip)
+{
+    memcpy(destination, SCC_STATE(chip), SCC_STATE_SIZE);
+    return SCC_STATE_SIZE;
+}
+
+int SCCLoadState(SCC *chip, const void *source)
+{
+    memcpy(SCC_STATE(chip), source, SCC_STATE_SIZE);
+    for (int reg=0xF; reg>=0; reg--)
+    {
+        SCCWrite(SCC_STATE(chip)[0x80+reg], 0x80+reg, chip);
+    }
+    return SCC_STATE_SIZE;
+}
+
+int SCCGetStateSize(void)
+{
+    return SCC_STATE_SIZE;
+}
+
+// ---------------------------------------------------------------------------------------
+// Like the assembly version, the wave RAM read is relative to the start of the struct.
+// ---------------------------------------------------------------------------------------
+u8 SCCRead(u16 address, SCC *chip)
+{
+    if (address & 0x80) return 0xFF;
+    return ((u8 *)chip)[address & 0x7F];
+}
+
+void SCCWrite(u8 value, u16 address, SCC *chip)
+{
+    u8 adr = address & 0xFF;            // 0x00-0x7F wave ram.
+    if (adr >= 0x90) adr -= 0x10;       // 0x80-0x8F registers, 0x90-0x9F mirror.
+    if (adr >= 0x90)                    // 0xE0-0xFF test register, all mirrors.
+    {
+        chip->testReg = value;
+        return;
+    }
+    SCC_STATE(chip)[adr] = value;
+    if (adr < 0x80) return;
+
+    u8 reg = adr - 0x80;
+    if (reg < 0x0A)                     // Frequency low/high for channels 0-4
+    {
+        u8 *freq = (u8 *)&(&chip->ch0Freq)[(reg >> 1) << 1];
+        if (reg & 1) freq[1] = (freq[1] & 0xF0) | (value & 0x0F);
+        else         freq[0] = value;
+    }
+    else if (reg < 0x0F)                // Volume for channels 0-4
+    {
+        u8 ch = reg - 0x0A;
+        u8 vol = value & 0x0F;
+        if (vol && (chip->chControl & (1 << ch))) vol = SCCVolume[vol];
+        sccVolume[ch] = vol;
+    }
+                                        // 0x8F key on - only takes effect on the next volume write
+}
+
+#endif // !__arm__ || SOUND_C_CORES
@@ -84,6 +84,15 @@ int sn76496GetStateSize(void);
  */
 void sn76496Mixer(int count, s16 *dest, SN76496 *chip);
 
+/**
+ * Renders count amount of samples like sn76496Mixer but at the output rate,
+ * with band-limited steps instead of oversampling (see SN76496_BL.c).
+ * @param  count: Number of samples to render.
+ * @param  *dest: Pointer to buffer where sound is rendered.
+ * @param  *chip: The SN76496 chip.
+ */
+void sn76496MixerBL(int count, s16 *dest, SN76496 *chip);
+
 /**
  * Write value to SN76496 chip
  * @param  value: value to write.
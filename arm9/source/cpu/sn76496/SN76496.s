@@ -5,7 +5,7 @@
 ;@  Created by Fredrik Ahlström on 2009-08-25.
 ;@  Copyright © 2009-2024 Fredrik Ahlström. All rights reserved.
 ;@
-#ifdef __arm__
+#if defined(__arm__) && !defined(SOUND_C_CORES)
 
 #include "SN76496.i"
 
@@ -263,4 +263,4 @@ attenuation:				;@ each step * 0.79370053 (-2dB?)
 	.long 0x2851,0x2000,0x1966,0x1428,0x1000,0x0CB3,0x0A14,0x0000
 ;@----------------------------------------------------------------------------
 	.end
-#endif // #ifdef __arm__
+#endif // #if defined(__arm__) && !defined(SOUND_C_CORES)
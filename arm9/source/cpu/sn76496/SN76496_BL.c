@@ -0,0 +1,131 @@
+//
+//  SN76496_BL.c
+//  Band-limited renderer for the SN76496/SN76489 sound chip emulator.
+//
+//  sn76496Mixer() clocks the chip SN_UPSHIFT times per output sample to keep
+//  the aliasing down. This renders from the same SN76496 struct at the output
+//  rate instead - each channel just adds a whole sample worth of counting and
+//  every time a channel flips, the step is smoothed over the two neighbouring
+//  samples with a polynomial band-limited step (polyBLEP). Either renderer can
+//  be used at any time as both keep the chip state the same way.
+//
+#include <nds.h>
+#include <stddef.h>
+
+#include "SN76496.h"
+
+#ifdef SN_UPSHIFT
+    #define USHIFT      SN_UPSHIFT
+#else
+    #define USHIFT      0
+#endif
+
+#define SN_ADDITION     0x00400000
+#define SN_STEP         ((SN_ADDITION >> 16) << USHIFT)     // Counter units per output sample
+#define SN_VOL_OFFSET   offsetof(SN76496, calculatedVolumes)
+
+static const u16 attenuation[16] =      // same as the oversampled mixer (>> 2 to the same output level)
+{
+    0xFFFF,0xCB30,0xA145,0x8000,0x6598,0x50A3,0x4000,0x32CC,
+    0x2851,0x2000,0x1966,0x1428,0x1000,0x0CB3,0x0A14,0x0000
+};
+
+// ---------------------------------------------------------------------------------------
+// The level we last output (before the BLEP correction) and the correction still owed
+// to the next sample. Like the SCC volumes, these live outside the SN76496 struct so the
+// saved state is the same whichever renderer is used.
+// ---------------------------------------------------------------------------------------
+static s32 blepLevel __attribute__((section(".dtcm"))) = 0;
+static s32 blepCarry __attribute__((section(".dtcm"))) = 0;
+
+// ---------------------------------------------------------------------------------------
+// A step of 'delta' that happened 'frac' (1/256ths of a sample) before the end of the
+// sample interval. The sample before the step is pulled towards the new level and the
+// sample after it back towards the old one - the two halves of the polyBLEP residual.
+// ---------------------------------------------------------------------------------------
+static inline __attribute__((always_inline)) void blepStep(s32 delta, u32 frac, s32 *before)
+{
+    u32 early = 256 - frac;
+    *before   += (delta * (s32)((frac*frac) >> 9)) >> 8;
+    blepCarry -= (delta * (s32)((early*early) >> 9)) >> 8;
+}
+
+static inline __attribute__((always_inline)) s32 snLevel(u32 chBits, const s32 *vol)
+{
+    s32 level = 0;
+    if (chBits & 0x02) level += vol[0];
+    if (chBits & 0x04) level += vol[1];
+    if (chBits & 0x08) level += vol[2];
+    if (chBits & 0x10) level += vol[3];
+    return level;
+}
+
+ITCM_CODE void sn76496MixerBL(int count, s16 *dest, SN76496 *chip)
+{
+    u32 cnt[4], frq[4];
+    s32 vol[4];
+    u32 bits = chip->currentBits - SN_VOL_OFFSET;
+    u32 rng = chip->rng;
+    u32 noiseFB = chip->noiseFB;
+
+    for (int ch=0; ch<4; ch++)
+    {
+        cnt[ch] = (&chip->ch0Cnt)[ch<<1];
+        frq[ch] = (&chip->ch0Frq)[ch<<1];
+        if (!frq[ch]) frq[ch] = 0x10000;            // A zero reload leaves the 16-bit counter where it wrapped to
+        vol[ch] = attenuation[(&chip->ch0Att)[ch<<1] & 0xF] >> 2;
+    }
+
+    s32 level = blepLevel;
+    s32 now = snLevel(bits, vol);
+
+    while (count-- > 0)
+    {
+        s32 out = level + blepCarry;
+        blepCarry = 0;
+
+        if (now != level)                           // A volume was written - step right at the start of this sample
+        {
+            blepStep(now - level, 256, &out);
+            level = now;
+        }
+
+        for (int ch=0; ch<4; ch++)
+        {
+            u32 c = cnt[ch] + SN_STEP;
+            while (c >= 0x10000)                    // The counter wrapped 'c - 0x10000' units before the end of the sample
+            {
+                u32 frac = ((c - 0x10000) << 8) / SN_STEP;
+                u32 old = bits;
+                if (ch < 3) bits ^= (0x02 << ch);
+                else
+                {
+                    bits &= ~0x10;
+                    if (rng & 1)
+                    {
+                        rng = (rng >> 1) ^ noiseFB;
+                        bits |= 0x10;
+                    }
+                    else rng >>= 1;
+                }
+                if (bits != old)
+                {
+                    now = snLevel(bits, vol);
+                    blepStep(now - level, frac, &out);
+                    level = now;
+                }
+                c -= frq[ch];                       // Same as the reload in the oversampled mixer (modulo 0x10000)
+            }
+            cnt[ch] = c;
+        }
+
+        if (out < 0) out = 0;
+        else if (out > 0xFFFF) out = 0xFFFF;
+        *dest++ = (s16)(out ^ 0x8000);
+    }
+
+    for (int ch=0; ch<4; ch++) (&chip->ch0Cnt)[ch<<1] = cnt[ch];
+    chip->currentBits = bits + SN_VOL_OFFSET;
+    chip->rng = rng;
+    blepLevel = level;
+}
@@ -0,0 +1,220 @@
+//
+//  SN76496_C.c
+//  Portable C version of the SN76496/SN76489 sound chip emulator.
+//
+//  This follows SN76496.s (Fredrik Ahlström, 2009-2024) step for step so that
+//  both produce the same samples from the same register writes. It uses the
+//  same SN76496 struct and API - build with SOUND_C_CORES (or for anything that
+//  isn't ARM) to use this in place of the assembly version.
+//
+#include <nds.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "SN76496.h"
+
+#if !defined(__arm__) || defined(SOUND_C_CORES)
+
+                                        // These values are for the SMS/GG/MD vdp/sound chip.
+#define PFEED_SMS   0x8000              // Periodic Noise Feedback
+#define WFEED_SMS   0x9000              // White Noise Feedback
+
+                                        // These values are for the SN76489/SN76496 sound chip.
+#define PFEED_SN    0x4000              // Periodic Noise Feedback
+#define WFEED_SN    0x6000              // White Noise Feedback
+
+                                        // These values are for the NCR 8496 sound chip.
+#define PFEED_NCR   0x4000              // Periodic Noise Feedback
+#define WFEED_NCR   0x4400              // White Noise Feedback
+
+#define SN_ADDITION 0x00400000
+
+#ifdef SN_UPSHIFT
+    #define USHIFT      SN_UPSHIFT
+    #define ZERO_VOL    0x0000
+#else
+    #define USHIFT      0
+    #define ZERO_VOL    0x8000
+#endif
+
+// ---------------------------------------------------------------------------------------
+// currentBits holds the offset of calculatedVolumes within the struct plus one bit per
+// channel that is currently high (0x02, 0x04, 0x08 and 0x10 for the noise) - exactly
+// as the assembly version keeps it so that saved states are interchangeable.
+// ---------------------------------------------------------------------------------------
+#define SN_VOL_OFFSET   offsetof(SN76496, calculatedVolumes)
+
+static const u32 attenuation[16] =      // each step * 0.79370053 (-2dB?)
+{
+    0xFFFF,0xCB30,0xA145,0x8000,0x6598,0x50A3,0x4000,0x32CC,
+    0x2851,0x2000,0x1966,0x1428,0x1000,0x0CB3,0x0A14,0x0000
+};
+
+// ---------------------------------------------------------------------------------------
+// Build the 16 possible mixes of the four channels being high or low.
+// ---------------------------------------------------------------------------------------
+static void calculateVolumes(SN76496 *chip)
+{
+    u32 vol0 = attenuation[chip->ch0Att & 0xF];
+    u32 vol1 = attenuation[chip->ch1Att & 0xF];
+    u32 vol2 = attenuation[chip->ch2Att & 0xF];
+    u32 vol3 = attenuation[chip->ch3Att & 0xF];
+
+    for (int i=15; i>0; i--)            // Entry 0 (all channels low) is left at ZERO_VOL
+    {
+        u32 vol = 0;
+        if (i & 0x01) vol += vol0;
+        if (i & 0x02) vol += vol1;
+        if (i & 0x04) vol += vol2;
+        if (i & 0x08) vol += vol3;
+        chip->calculatedVolumes[i] = (s16)(ZERO_VOL ^ (vol >> (2+USHIFT)));
+    }
+    chip->snAttChg = 0;
+}
+
+ITCM_CODE void sn76496Mixer(int count, s16 *dest, SN76496 *chip)
+{
+    u32 ch0 = chip->ch0Frq | ((u32)chip->ch0Cnt << 16);
+    u32 ch1 = chip->ch1Frq | ((u32)chip->ch1Cnt << 16);
+    u32 ch2 = chip->ch2Frq | ((u32)chip->ch2Cnt << 16);
+    u32 ch3 = chip->ch3Frq | ((u32)chip->ch3Cnt << 16);
+    u32 bits = chip->currentBits;
+    u32 rng = chip->rng;
+    u32 noiseFB = chip->noiseFB;
+    u32 mix, t;
+
+    if (chip->snAttChg) calculateVolumes(chip);
+
+    count <<= USHIFT;
+    do
+    {
+#if USHIFT
+        mix = 0x8000;
+        do
+        {
+#endif
+            // Each counter counts up in the top half of the word and reloads with the frequency in the bottom half
+            t = ch0 + SN_ADDITION; if (t < ch0) {t -= t << 16; bits ^= 0x02;} ch0 = t;
+            t = ch1 + SN_ADDITION; if (t < ch1) {t -= t << 16; bits ^= 0x04;} ch1 = t;
+            t = ch2 + SN_ADDITION; if (t < ch2) {t -= t << 16; bits ^= 0x08;} ch2 = t;
+            t = ch3 + SN_ADDITION;
+            if (t < ch3)
+            {
+                t -= t << 16;
+                bits &= ~0x10;
+                if (rng & 1)
+                {
+                    rng = (rng >> 1) ^ noiseFB;
+                    bits |= 0x10;
+                }
+                else rng >>= 1;
+            }
+            ch3 = t;
+
+#if USHIFT
+            mix += (u16)chip->calculatedVolumes[(bits - SN_VOL_OFFSET) >> 1];
+            count--;
+        } while (count & ((1<<USHIFT)-1));
+#else
+            mix = (u16)chip->calculatedVolumes[(bits - SN_VOL_OFFSET) >> 1];
+            count--;
+#endif
+        if (count >= 0) *dest++ = (s16)mix;
+    } while (count > 0);
+
+    chip->ch0Cnt = ch0 >> 16;
+    chip->ch1Cnt = ch1 >> 16;
+    chip->ch2Cnt = ch2 >> 16;
+    chip->ch3Cnt = ch3 >> 16;
+    chip->currentBits = bits;
+    chip->rng = rng;
+}
+
+void sn76496Reset(int chiptype, SN76496 *chip)
+{
+    u32 feed = (WFEED_SMS<<16) | PFEED_SMS;
+    if (chiptype == 1) feed = (WFEED_SN<<16) | PFEED_SN;
+    else if ((unsigned)chiptype > 1) feed = (WFEED_NCR<<16) | PFEED_NCR;
+
+    memset(chip, 0x00, sizeof(SN76496));
+
+    chip->rng = feed & 0xFFFF;
+    chip->noiseFB = feed >> 16;
+    chip->noiseType = feed;
+    chip->currentBits = SN_VOL_OFFSET;
+    chip->calculatedVolumes[0] = (s16)ZERO_VOL;
+}
+
+int sn76496SaveState(void *destination, const SN76496 *chip)
+{
+    memcpy(destination, chip, sizeof(SN76496));
+    return sizeof(SN76496);
+}
+
+int sn76496LoadState(SN76496 *chip, const void *source)
+{
+    memcpy(chip, source, sizeof(SN76496));
+    chip->snAttChg = 1;
+    return sizeof(SN76496);
+}
+
+int sn76496GetStateSize(void)
+{
+    return sizeof(SN76496);
+}
+
+// ---------------------------------------------------------------------------------------
+// The noise channel takes its reset value and feedback from noiseType - only the low
+// halfword of rng and noiseFB is written, just like the strh in the assembly version.
+// ---------------------------------------------------------------------------------------
+static void setNoiseFreq(u8 val, SN76496 *chip)
+{
+    u8 rate = val & 3;
+    u32 type = chip->noiseType;
+
+    chip->ch3Reg = (chip->ch3Reg & 0xFF00) | rate;
+    chip->rng = (chip->rng & 0xFFFF0000) | (type & 0xFFFF);
+    if (val & 4) type >>= 16;           // White noise
+    chip->noiseFB = (chip->noiseFB & 0xFFFF0000) | (type & 0xFFFF);
+    chip->ch3Frq = (rate == 3) ? chip->ch2Frq : (0x0400 << rate);    // These values sound ok
+}
+
+void sn76496W(u8 val, SN76496 *chip)
+{
+    u8 reg;
+
+    if (val & 0x80) chip->snLastReg = reg = (val & 0x70);
+    else reg = chip->snLastReg;
+
+    u8 ch = reg >> 5;
+    u16 *chReg = &chip->ch0Reg + (ch << 1);     // chXReg and chXAtt are pairs of halfwords
+    u16 *chAtt = chReg + 1;
+
+    if (reg & 0x10)                     // Volume
+    {
+        u8 change = (*chAtt & 0xFF) ^ (val & 0x0F);
+        if (change)
+        {
+            *chAtt = (*chAtt & 0xFF00) | (val & 0x0F);
+            chip->snAttChg = change;
+        }
+        return;
+    }
+
+    if (ch == 3)                        // Noise channel
+    {
+        setNoiseFreq(val, chip);
+        return;
+    }
+
+    if (val & 0x80) *chReg = (*chReg & 0xFF00) | ((val << 4) & 0xFF);
+    else            *chReg = (*chReg & 0x00FF) | ((val & 0x3F) << 8);
+
+    u32 freq = (u32)*chReg << 2;
+    if (freq < 0x0180) freq = 0x0040;   // We set any value under 6 to 1 to fix aliasing. Value zero is same as 1 on SMS.
+    (&chip->ch0Frq)[ch << 1] = (u16)freq;
+
+    if ((ch == 2) && ((chip->ch3Reg & 0xFF) == 3)) chip->ch3Frq = (u16)freq;   // Noise follows channel 2
+}
+
+#endif // !__arm__ || SOUND_C_CORES
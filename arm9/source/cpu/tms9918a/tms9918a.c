@@ -52,15 +52,31 @@
 #include "../z80/ctc.h"
 
 #include "tms9918a.h"
+#include "../../vdpcapture.h"
+#include "../../CRC32.h"
 
 u8 MaxSprites[2] __attribute__((section(".dtcm"))) = {32, 4};     // Normally the CV only shows 4 sprites on a line... for emulation we bump this up if configured
 
-u16 *pVidFlipBuf __attribute__((section(".dtcm"))) = (u16*) (0x06000000);    // Video flipping buffer
+u16 *pVidFlipBuf __attribute__((section(".dtcm"))) = VDP_SINK_BG3;    // Video flipping buffer
 
 u8 XBuf_A[256*192] ALIGN(32) = {0}; // TMS9918 screen is 256x192 - Ping Pong Buffer A
 u8 XBuf_B[256*192] ALIGN(32) = {0}; // TMS9918 screen is 256x192 - Ping Pong Buffer B
 u8 *XBuf __attribute__((section(".dtcm"))) = XBuf_A;
 
+// ---------------------------------------------------------------------------------------
+// Frame sink. Every line is rendered into a small line buffer in fast DTCM (we can't
+// render into VRAM itself as it ignores byte writes) and the finished line goes into
+// XBuf - the row is flagged in vdp_dirty_rows only if it really changed. Nothing is
+// written to the display mid-frame (that tears and costs 48K of CPU stores to slow
+// VRAM every frame) - at vertical blank colecoUpdateScreen() either merges the changed
+// rows of XBuf_A/XBuf_B into VRAM for the CPU blend or sends the changed rows to the
+// display with an asynchronous DMA. The 'DS LAYERS' blend alternates XBuf_A/XBuf_B
+// with the BG3 and BG2 bitmaps and the DS alpha blends the two layers at no CPU cost.
+// ---------------------------------------------------------------------------------------
+u8 XLine[256] ALIGN(32) __attribute__((section(".dtcm")));
+u8 vdp_sink   __attribute__((section(".dtcm"))) = 0xFF;   // The FRAME_BLEND_xxx the sink is set up for (0xFF = not yet set up)
+u32 vdp_dirty_rows[192/32] __attribute__((section(".dtcm"))) = {0};   // One bit per row changed since it last went to the display
+
 // Look up table for colors - pre-generated and in VRAM for maximum speed!
 u32 (*lutTablehh)[16][16] __attribute__((section(".dtcm"))) = (void*)0x068A0000;    // this is actually 16x16x16x4 = 16K
 
@@ -71,6 +87,16 @@ u16 vdp_int_source       __attribute__((section(".dtcm"))) = 0;
 u16 my_config_clear_int  __attribute__((section(".dtcm"))) = 0;
 
 
+// Counts down once per displayed frame after any VDP change - when zero the frame is identical to the last one.
+// It is set from vdp_changed once per frame (colecoUpdateScreen) so the VDP ports only have to store a flag.
+u8 vdp_dirty __attribute__((section(".dtcm"))) = VDP_DIRTY_FRAMES;
+
+// Set to 1 by any VRAM or VDP register write - renderers that reuse work across lines fold it into vdp_dirty and clear it
+u8 vdp_changed __attribute__((section(".dtcm"))) = 1;
+
+// CRC32 of the last rendered frame - only computed for the full debugger so renderer changes can be checked for pixel-exactness
+u32 vdp_frame_crc = 0;
+
 u8 OH __attribute__((section(".dtcm"))) = 0;
 u8 IH __attribute__((section(".dtcm"))) = 0;
 
@@ -80,13 +106,14 @@ u8 IH __attribute__((section(".dtcm"))) = 0;
 // all seem to refer to 'Modes' vs 'Screens' vs more colorful names for the modes
 // plus there are the undocumented modes. So I've done my best to comment using 
 // all of the names you will find out there in the wild world of VDP documentation!
+// The second handler is used when the table masks are not the standard (unmirrored) layout.
 // ---------------------------------------------------------------------------------------
 tScrMode SCR[MAXSCREEN+1] __attribute__((section(".dtcm")))  = {
-                // R2,  R3,  R4,  R5,  R6,  M2,  M3,  M4,  M5
-  { RefreshLine0,0x7F,0x00,0x3F,0x00,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 1 aka MSX SCREEN 0 aka "TEXT 1"     */
-  { RefreshLine1,0x7F,0xFF,0x3F,0xFF,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 0 aka MSX SCREEN 1 aka "GRAPHIC 1"  */
-  { RefreshLine2,0x7F,0x80,0x3C,0xFF,0x3F,0x00,0x7F,0x03,0x00 }, /* VDP Mode 3 aka MSX SCREEN 2 aka "GRAPHIC 2"  */
-  { RefreshLine3,0x7F,0x00,0x3F,0xFF,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 2 aka MSX SCREEN 3 aka "MULTICOLOR" */
+  // Standard    Masked          R2,  R3,  R4,  R5,  R6,  M2,  M3,  M4,  M5
+  { RefreshLine0, RefreshLine0,  0x7F,0x00,0x3F,0x00,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 1 aka MSX SCREEN 0 aka "TEXT 1"     */
+  { RefreshLine1, RefreshLine1,  0x7F,0xFF,0x3F,0xFF,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 0 aka MSX SCREEN 1 aka "GRAPHIC 1"  */
+  { RefreshLine2, RefreshLine2M, 0x7F,0x80,0x3C,0xFF,0x3F,0x00,0x7F,0x03,0x00 }, /* VDP Mode 3 aka MSX SCREEN 2 aka "GRAPHIC 2"  */
+  { RefreshLine3, RefreshLine3,  0x7F,0x00,0x3F,0xFF,0x3F,0x00,0x00,0x00,0x00 }, /* VDP Mode 2 aka MSX SCREEN 3 aka "MULTICOLOR" */
 };
 
 void (*RefreshLine)(u8 uY) __attribute__((section(".dtcm"))) = RefreshLine0;
@@ -288,6 +315,72 @@ ITCM_CODE int ScanSprites(byte Y, unsigned int *Mask)
 }
 
 
+/** LinePtr9918() / LineDone9918() ***************************/
+/** Where the renderers draw line uY and what to do with it **/
+/** once it's complete (background and sprites).            **/
+/*************************************************************/
+static inline u8 *LinePtr9918(u8 uY)
+{
+  return XLine;
+}
+
+static inline void LineDone9918(u8 uY)
+{
+  // Only a row that differs from what this XBuf already holds needs to go out again
+  u32 *src = (u32*)XLine;
+  u32 *dst = (u32*)XBuf + (uY<<6);
+  int X = 0;
+  while ((X < 256/4) && (src[X] == dst[X])) X++;
+  if (X < 256/4)
+  {
+      for (; X<256/4; X++) dst[X] = src[X];
+      vdp_dirty_rows[uY>>5] |= (1 << (uY&31));
+  }
+}
+
+/** SelectSink9918() *****************************************/
+/** Set up how the frame in XBuf gets to the display - CPU  **/
+/** blended, DMA to BG3 or DMA to alternate DS layers.      **/
+/*************************************************************/
+void SelectSink9918(void)
+{
+  if (myConfig.frameBlend != vdp_sink)
+  {
+      vdp_sink   = myConfig.frameBlend;
+      XBuf = XBuf_A;
+      pVidFlipBuf = VDP_SINK_BG3;
+      memset(vdp_dirty_rows, 0xFF, sizeof(vdp_dirty_rows));  // The first frame out must cover every row
+      vdp_dirty = VDP_DIRTY_FRAMES;                          // ...and must go out even if the picture is static
+      InvalidateTextCache();    // The text line cache describes whatever we were drawing into before
+
+      if (vdp_sink == FRAME_BLEND_LAYERS)
+      {
+          // BG2 is a second 256x256 bitmap right after the BG3 one
+          REG_BG2CNT = BG_BMP8_256x256 | BG_BMP_BASE(4);
+          REG_BG2PA = (1<<8);
+          REG_BG2PB = 0;
+          REG_BG2PC = 0;
+          REG_BG2PD = (1<<8);
+          REG_BG2X = 0;
+          REG_BG2Y = 0;
+          // Both frame buffers and both layers start the same so the changed rows of either frame are all that need to go out
+          memcpy(XBuf_B, XBuf_A, 256*192);
+          memcpy(VDP_SINK_BG2, XBuf_A, 256*192);
+
+          // Half of each layer... color 0 is transparent so black pixels show the other frame at full brightness
+          REG_BLDCNT   = BLEND_ALPHA | BLEND_SRC_BG2 | BLEND_DST_BG3;
+          REG_BLDALPHA = 8 | (8<<8);
+      }
+      else
+      {
+          REG_DISPCNT &= ~DISPLAY_BG2_ACTIVE;
+          REG_BLDCNT   = 0;
+      }
+  }
+
+  if (vdp_sink == FRAME_BLEND_LAYERS) REG_DISPCNT |= DISPLAY_BG2_ACTIVE;  // A menu may have put the display back to BG3 only
+}
+
 /** RefreshSprites() *****************************************/
 /** This function is called from RefreshLine#() to refresh  **/
 /** and draw sprites to a given pixel line.                 **/
@@ -303,7 +396,7 @@ ITCM_CODE void RefreshSprites(register byte Y)
   N = ScanSprites(Y,&M);
   if((N<0) || !M) return;
 
-  T  = XBuf+256*Y;
+  T  = LinePtr9918(Y);
   AT = SprTab+(N<<2);
 
   /* For each possibly shown sprite... */
@@ -412,58 +505,70 @@ ITCM_CODE void RefreshSprites(register byte Y)
 /** this line.  This is the only mode that shows fewer than   **/
 /** 256 horizontal pixels and so we must deal with the border **/
 /** (backdrop) here which is always the background color.     **/
+/**                                                           **/
+/** Each 6-pixel glyph row only depends on the pattern byte   **/
+/** and the FG/BG colors so we expand two cells at a time     **/
+/** straight out of the color look-up table and write three   **/
+/** aligned words. We also remember the pattern bytes we drew **/
+/** on every line of each XBuf so that text lines which have  **/
+/** not changed (very common in BASIC and CP/M) are skipped.  **/
 /***************************************************************/
-ITCM_CODE void RefreshLine0(u8 Y)
+u8  TextLinePat[2][192][40] ALIGN(4);   // Pattern bytes last drawn on each line of XBuf_A / XBuf_B
+u16 TextLineColor[2][192];              // FG/BG colors last drawn on each line (0xFFFF = not drawn in text mode)
+
+void InvalidateTextCache(void)
 {
-  register byte *T,K,Offset;
-  register byte *P,FC,BC;
-  u16 word1=0, word2=0, word3=0;
+  memset(TextLineColor, 0xFF, sizeof(TextLineColor));
+}
 
-  P=XBuf+(Y<<8);
-  BC = BGColor;
-  FC = FGColor;
+ITCM_CODE void RefreshLine0(u8 Y)
+{
+  u32 *P = (u32*)LinePtr9918(Y);
+  u8 buf = (XBuf == XBuf_B) ? 1:0;
 
   if(!ScreenON)
+  {
     memset(P,BGColor,256);
+    TextLineColor[buf][Y] = 0xFFFF;
+  }
   else
   {
-    T=ChrTab+(Y>>3)*40;
-    Offset=Y&0x07;
+    u8 *T   = ChrTab+(Y>>3)*40;
+    u8 *G   = ChrGen+(Y&0x07);
+    u8 *Pat = TextLinePat[buf][Y];
+    u16 color = (FGColor<<4) | BGColor;
+    u8 bSame = (TextLineColor[buf][Y] == color);
 
-    u8 lastT = ~(*T);
+    // Gather the 40 pattern bytes for this line and see if anything changed since we last drew it
+    for(int X=0;X<40;X++)
+    {
+      u8 K = G[(int)T[X]<<3];
+      if (Pat[X] != K) {Pat[X] = K; bSame = 0;}
+    }
+    if (bSame) return;    // Exactly what's already in this buffer (or on the display)
+    TextLineColor[buf][Y] = color;
 
-    memset(P, BGColor, 8);  // Fill the first 8 pixels with background color since the screen in TEXT mode is 240 pixels and needs the border filled
-    P += 8;                 // For this TEXT mode, we shift in 8 pixels to center the screen. We memset the background color to the first and last 8 pixels of a line to blank them.
+    u32 *ptLut = (u32*)(lutTablehh[FGColor][BGColor]);
+    u32 border = ptLut[0];
 
-    for(int X=0;X<40;X++)
+    *P++ = border;        // The screen in TEXT mode is 240 pixels so the first and last 8 pixels are the border
+    *P++ = border;
+
+    // Two 6-pixel cells make exactly three 32-bit words
+    for(int X=0;X<40;X+=2)
     {
-      if (lastT != *T) // Is this set of pixels different than the last one?
-      {
-          lastT=*T;
-          K=ChrGen[((int)*T<<3)+Offset];
-          P[0]=K&0x80? FC:BC;
-          P[1]=K&0x40? FC:BC;
-          P[2]=K&0x20? FC:BC;
-          P[3]=K&0x10? FC:BC;
-          P[4]=K&0x08? FC:BC;
-          P[5]=K&0x04? FC:BC;
-          // Save the data as we are likely to just repeat it...
-          word1 = *((u16*)(P+0));
-          word2 = *((u16*)(P+2));
-          word3 = *((u16*)(P+4));
-      }
-      else // No change so we can just blast repeat the 6 bytes (16-bits at at time). This occurs frequently and saves us time.
-      {
-          u16 *destPtr = (u16*)P;
-          *destPtr++ = word1;
-          *destPtr++ = word2;
-          *destPtr   = word3;
-      }
-      P+=6;T++;
+      u8 K1 = Pat[X];
+      u8 K2 = Pat[X+1];
+      u32 mid = ptLut[K2>>4];
+      *P++ = ptLut[K1>>4];
+      *P++ = (ptLut[K1&0x0F] & 0x0000FFFF) | (mid << 16);
+      *P++ = (mid >> 16) | (ptLut[K2&0x0F] << 16);
     }
 
-    memset(P, BGColor, 8);  // Fill the last 8 pixels with background color since the screen in TEXT mode is 240 pixels and needs the border filled
+    *P++ = border;
+    *P   = border;
   }
+  LineDone9918(Y);
 }
 
 /** RefreshLine1() *******************************************/
@@ -477,7 +582,7 @@ ITCM_CODE void RefreshLine1(u8 uY)
   register u32 *P;
   u8 lastT;
 
-  P=(u32*) (XBuf+(uY<<8));
+  P=(u32*)LinePtr9918(uY);
   u32 ptLow = 0; u32 ptHigh = 0;
 
   if(!ScreenON) 
@@ -508,11 +613,14 @@ ITCM_CODE void RefreshLine1(u8 uY)
     }
     RefreshSprites(uY);
   }
+  LineDone9918(uY);
 }
 
 /** RefreshLine2() *******************************************/
 /** Refresh line Y (0..191) of SCREEN2, including sprites   **/
-/** in this line.                                           **/
+/** in this line. This is the standard 3-table layout where **/
+/** the color and pattern masks don't mirror anything, so   **/
+/** there is no masking needed in the inner loop.           **/
 /*************************************************************/
 ITCM_CODE void RefreshLine2(u8 uY) {
   u32 *P;
@@ -520,7 +628,56 @@ ITCM_CODE void RefreshLine2(u8 uY) {
   register byte K,*T;
   u16 J,I;
 
-  P=(u32*)(XBuf+(uY<<8));
+  P=(u32*)LinePtr9918(uY);
+
+  if (!ScreenON) 
+    memset(P,BGColor,256);
+  else 
+  {
+    u32 ptLow = 0; u32 ptHigh = 0;
+      
+    J   = ((u16)((u16)uY&0xC0)<<5)+(uY&0x07);
+    T   = ChrTab+((u16)((u16)uY&0xF8)<<2);
+    u8 *pCol = ColTab+J;
+    u8 *pGen = ChrGen+J;
+    u8 lastT = ~(*T);
+
+    for(int X=0;X<32;X++)
+    {
+      if (lastT != *T)
+      {
+          lastT = *T;
+          I    = (u16)lastT<<3;
+          K    = pCol[I];
+          FC   = (K>>4);
+          BC   = K & 0x0F;
+          K    = pGen[I];
+          u32* ptLut = (u32*)(lutTablehh[FC][BC]);
+          ptLow = *(ptLut + ((K>>4)));
+          ptHigh = *(ptLut + ((K & 0xF)));
+      } 
+      *P++ = ptLow;
+      *P++ = ptHigh;
+      T++;
+    }
+      
+    RefreshSprites(uY);
+  }    
+  LineDone9918(uY);
+}
+
+/** RefreshLine2M() ******************************************/
+/** Refresh line Y (0..191) of SCREEN2 where the color and  **/
+/** pattern tables are mirrored (undocumented masks used by **/
+/** a number of games and the "half bitmap" modes).         **/
+/*************************************************************/
+ITCM_CODE void RefreshLine2M(u8 uY) {
+  u32 *P;
+  register byte FC,BC;
+  register byte K,*T;
+  u16 J,I;
+
+  P=(u32*)LinePtr9918(uY);
 
   if (!ScreenON) 
     memset(P,BGColor,256);
@@ -553,28 +710,73 @@ ITCM_CODE void RefreshLine2(u8 uY) {
       
     RefreshSprites(uY);
   }    
+  LineDone9918(uY);
+}
+
+/** RefreshLineOff() *****************************************/
+/** Refresh line Y (0..191) when the display is disabled -  **/
+/** the whole line is just the backdrop color. No sprites.  **/
+/*************************************************************/
+ITCM_CODE void RefreshLineOff(u8 uY)
+{
+  memset(LinePtr9918(uY),BGColor,256);
+  TextLineColor[(XBuf == XBuf_B) ? 1:0][uY] = 0xFFFF;   // Text mode will need to redraw this line
+  LineDone9918(uY);
+}
+
+/** SelectRefresh9918() **************************************/
+/** Pick the line renderer for the current mode, screen     **/
+/** enable and table mask configuration. This is done when  **/
+/** the registers are written so the per-cell inner loops   **/
+/** don't need to carry any masking or mode tests.          **/
+/*************************************************************/
+void SelectRefresh9918(void)
+{
+  if (!ScreenON) RefreshLine = RefreshLineOff;
+  else if (((ColTabM & 0x1FFF) == 0x1FFF) && ((ChrGenM & 0x1FFF) == 0x1FFF)) RefreshLine = SCR[ScrMode].Refresh;  // Standard - the masks can't affect a 0x0000-0x1FFF offset
+  else RefreshLine = SCR[ScrMode].RefreshM;
 }
 
 /** RefreshLine3() *******************************************/
 /** Refresh line Y (0..191) of SCREEN3, including sprites   **/
-/** in this line.                                           **/
+/** in this line. Every group of 4 lines has the same       **/
+/** background so we render it once into a small row cache **/
+/** and copy it for the next three lines - only the sprites **/
+/** are composited per line. Any VDP change drops the cache.**/
 /*************************************************************/
+u32 MultiColorRow[256/4] __attribute__((section(".dtcm")));   // Background for the current 4-line block
+u8  MultiColorBlock      __attribute__((section(".dtcm"))) = 0xFF;
+
 ITCM_CODE void RefreshLine3(u8 uY) 
 {
   byte X,K,Offset;
   byte *P,*T;
   u8 lastT;
-  P=XBuf+(uY<<8);
+  P=LinePtr9918(uY);
 
   if(!TMS9918_ScreenON) {
     memset(P,BGColor,256);
   }
+  else if ((MultiColorBlock == (uY>>2)) && !vdp_changed) {
+    // Same 4-line block as the last line and nothing in the VDP has changed - reuse the background
+    u32 *src = MultiColorRow;
+    u32 *dst = (u32*)P;
+    for (X=0; X<256/4; X+=4)
+    {
+        *dst++ = *src++;
+        *dst++ = *src++;
+        *dst++ = *src++;
+        *dst++ = *src++;
+    }
+    RefreshSprites(uY);
+  }
   else {
     u8 ptLow = 0; u8 ptHigh = 0;
     T=ChrTab+((int)(uY&0xF8)<<2);
     lastT = ~(*T);
     Offset=(uY&0x1C)>>2;
     u32 dword1=0, dword2=0;
+    u32 *row = MultiColorRow;
     for(X=0;X<32;X++) 
     {
       if (lastT != *T)
@@ -594,10 +796,16 @@ ITCM_CODE void RefreshLine3(u8 uY)
           *destPtr++ = dword1;
           *destPtr   = dword2;          
       }
+      *row++ = dword1;
+      *row++ = dword2;
       P+=8;T++;
     }
+    MultiColorBlock = uY>>2;
+    if (vdp_changed) vdp_dirty = VDP_DIRTY_FRAMES;   // Don't lose the change for this frame's screen update
+    vdp_changed = 0;
     RefreshSprites(uY);
   }
+  LineDone9918(uY);
 }
 
 
@@ -654,8 +862,8 @@ ITCM_CODE byte Write9918(u8 iReg, u8 value)
       if ((newMode!=ScrMode) || !VRAMMask) 
       {
         VRAMMask    = TMS9918_VRAMMask;
+        if (newMode == 0) InvalidateTextCache();   // XBuf holds another mode's pixels now
         ScrMode=newMode;
-        RefreshLine = SCR[ScrMode].Refresh;
         ChrTab=pVDPVidMem+(((int)(VDP[2]&SCR[ScrMode].R2)<<10)&VRAMMask);
         ColTab=pVDPVidMem+(((int)(VDP[3]&SCR[ScrMode].R3)<<6)&VRAMMask);
         ChrGen=pVDPVidMem+(((int)(VDP[4]&SCR[ScrMode].R4)<<11)&VRAMMask);
@@ -709,6 +917,9 @@ ITCM_CODE byte Write9918(u8 iReg, u8 value)
       break;
   }
 
+  /* Mode, screen enable and color/pattern masks select the line renderer */
+  if ((iReg < 5) && (iReg != 2)) SelectRefresh9918();
+
   /* Return IRQ, if generated */
   return(bIRQ);
 }
@@ -724,10 +935,43 @@ ITCM_CODE byte RdData9918(void)
   VAddr     = (VAddr+1)&0x3FFF;
   VDPCtrlLatch = 0;
 
+  if (vdp_log_active & VDP_LOG_CAPTURE) VDPCapture(VDP_CAP_DATA_RD, data);
+
   return(data);
 }
 
 
+/** WrBlock9918() ********************************************/
+/** Write len bytes from src to the VDP Data Port. This is  **/
+/** the same as len calls to WrData9918() but copies into   **/
+/** VRAM directly and only marks the picture dirty once.    **/
+/** Used to burst OTIR loops aimed at the VDP data port.    **/
+/*************************************************************/
+ITCM_CODE void WrBlock9918(const u8 *src, u16 len)
+{
+  if (!len) return;
+
+  // The deferred renderer and the capture need every write logged
+  if (vdp_log_active)
+  {
+      while (len--) WrData9918(*src++);
+      return;
+  }
+
+  u16 addr = VAddr;
+  while (len--)
+  {
+      pVDPVidMem[addr] = *src++;
+      addr = (addr+1)&0x3FFF;
+  }
+
+  vdp_changed  = 1;
+  VDPDlatch    = src[-1];
+  VAddr        = addr;
+  VDPCtrlLatch = 0;
+}
+
+
 /** WrCtrl9918() *********************************************/
 /** Write a value V to the VDP Control Port. Enabling IRQs  **/
 /** in this function may cause an IRQ to be generated. In   **/
@@ -735,12 +979,19 @@ ITCM_CODE byte RdData9918(void)
 /*************************************************************/
 ITCM_CODE byte WrCtrl9918(byte value) 
 {
+  if (vdp_log_active & VDP_LOG_CAPTURE) VDPCapture(VDP_CAP_CTRL_WR, value);
+
   if(VDPCtrlLatch)  // Write the high byte of the video address
   { 
     VDPCtrlLatch=0; // Set the VDP flip-flop so we do the low byte next
       
     VAddr = ((VAddr&0x00FF)|((u16)value<<8))&0x3FFF;                                // Set the high byte of the video address always
-    if (value & 0x80) return(Write9918(value&0x07,VAddr&0x00FF));                   // Might generate an IRQ if we end up enabling interrupts and VBlank set
+    if (value & 0x80)
+    {
+        if (VDP[value&0x07] != (VAddr & VDP_RegisterMasks[value&0x07])) vdp_changed = 1;
+        if (vdp_log_active) LogWrite9918(VDP_LOG_REGISTER | (value&0x07), VDP[value&0x07], VAddr&0x00FF);
+        return(Write9918(value&0x07,VAddr&0x00FF));                                 // Might generate an IRQ if we end up enabling interrupts and VBlank set
+    }
     if (!(value & 0x40)) {VDPDlatch = pVDPVidMem[VAddr]; VAddr = (VAddr+1)&0x3FFF;} // As long as we're not read inhibited (either uppper 2 bits set), read ahead
   }
   else  // Write the low byte of the video address / control register
@@ -768,17 +1019,134 @@ ITCM_CODE byte RdCtrl9918(void)
     if ((CPU.IRequest == vdp_int_source)) CPU.IRequest=INT_NONE;
   }
 
+  if (vdp_log_active & VDP_LOG_CAPTURE) VDPCapture(VDP_CAP_CTRL_RD, data);
+
   return(data);
 }
 
 
+// ---------------------------------------------------------------------------------------
+// Deferred rendering support. Normally we render each scanline as the emulated beam
+// passes it which interleaves the renderer with the Z80 core and thrashes the small
+// ARM9 caches. In deferred mode we instead log every VDP register and VRAM write made
+// during the visible part of the frame (stamped with the visible line) and render all
+// 192 lines in one batch at vertical blank. To reproduce mid-frame changes, the log
+// keeps both the old and new values: we roll VRAM and the registers back to the start
+// of the batch and then replay the writes forward as each line is rendered. If the log
+// fills up mid-frame, we simply render the batch so far and start a new batch.
+// ---------------------------------------------------------------------------------------
+typedef struct {
+    u16 addr;       // VRAM address or VDP_LOG_REGISTER | register number
+    u8  line;       // Visible line the write happened on (seen from line+1 onwards)
+    u8  oldVal;     // Value before the write - used to roll back
+    u8  newVal;     // Value written - used to replay
+} tVDPLog;
+
+tVDPLog VDPLog[VDP_LOG_SIZE] ALIGN(32);
+u16 vdp_log_len     __attribute__((section(".dtcm"))) = 0;
+u8  vdp_log_active  __attribute__((section(".dtcm"))) = 0;
+u8  vdp_log_line    __attribute__((section(".dtcm"))) = 0;  // Next visible line to be rendered from the log
+
+static inline void ApplyLog9918(tVDPLog *pLog, u8 value)
+{
+    vdp_changed = 1;
+    if (pLog->addr & VDP_LOG_REGISTER) Write9918(pLog->addr & 0x07, value);
+    else pVDPVidMem[pLog->addr] = value;
+}
+
+/** Flush9918() **********************************************/
+/** Render all lines from the last flush up to (but not     **/
+/** including) line uY, replaying the VDP write log so that **/
+/** mid-frame changes appear on the right lines.            **/
+/*************************************************************/
+ITCM_CODE void Flush9918(u8 uY)
+{
+    u8  saveStatus = VDPStatus;  // The 5th sprite status was already handled as the lines were scanned
+    u8  saveActive = vdp_log_active;
+    u16 idx;
+
+    vdp_log_active = 0;          // Don't log our own replay writes
+
+    // Roll back to the VDP state at the start of this batch...
+    for (idx = vdp_log_len; idx > 0; idx--)
+    {
+        ApplyLog9918(&VDPLog[idx-1], VDPLog[idx-1].oldVal);
+    }
+
+    // And then replay forward, one line at a time...
+    idx = 0;
+    for (u8 y = vdp_log_line; y < uY; y++)
+    {
+        while ((idx < vdp_log_len) && (VDPLog[idx].line < y))
+        {
+            ApplyLog9918(&VDPLog[idx], VDPLog[idx].newVal);
+            idx++;
+        }
+        RefreshLine(y);
+    }
+
+    // Anything left over happened after the last line we rendered
+    for ( ; idx < vdp_log_len; idx++)
+    {
+        ApplyLog9918(&VDPLog[idx], VDPLog[idx].newVal);
+    }
+
+    vdp_log_len    = 0;
+    vdp_log_line   = uY;
+    vdp_log_active = saveActive;
+    VDPStatus      = saveStatus;
+}
+
+/** LogWrite9918() *******************************************/
+/** Record a VDP register or VRAM write made while a frame  **/
+/** is being deferred or the VDP is being captured. Must be **/
+/** called before the write.                                **/
+/*************************************************************/
+ITCM_CODE void LogWrite9918(u16 addr, u8 oldVal, u8 newVal)
+{
+    if (vdp_log_active & VDP_LOG_CAPTURE)
+    {
+        if (!(addr & VDP_LOG_REGISTER)) VDPCapture(VDP_CAP_DATA_WR, newVal);   // Register writes were captured at the control port
+        if (!(vdp_log_active & VDP_LOG_DEFERRED)) return;
+    }
+
+    u8 line = CurLine - tms_start_line;
+
+    if (vdp_log_len == VDP_LOG_SIZE)    // Log is full - render what we have so far
+    {
+        Flush9918(line+1);
+    }
+
+    VDPLog[vdp_log_len].addr   = addr;
+    VDPLog[vdp_log_len].line   = line;
+    VDPLog[vdp_log_len].oldVal = oldVal;
+    VDPLog[vdp_log_len].newVal = newVal;
+    vdp_log_len++;
+}
+
+/** ResetLog9918() *******************************************/
+/** Discard any deferred writes - used when the VDP state   **/
+/** is replaced wholesale (reset, save state restore, etc). **/
+/** A capture in progress is written out and ended here as  **/
+/** what follows could not be replayed from its start state.**/
+/*************************************************************/
+void ResetLog9918(void)
+{
+    if (vdp_cap_buffer) VDPCaptureStop();
+
+    vdp_log_len    = 0;
+    vdp_log_line   = 0;
+    vdp_log_active = 0;
+}
+
+
 /** Loop9918() ***********************************************/
 /** Call this routine on every scanline to update the       **/
 /** screen buffer. Loop9918() returns 1 if an interrupt is  **/
 /** to be generated, 0 otherwise.                           **/
 /*************************************************************/
 u8 frameSkipIdx __attribute__((section(".dtcm"))) = 0;
-u8 frameSkip[3] __attribute__((section(".dtcm"))) = {0xFF, 0x03, 0x01};   // Frameskip OFF, Light, Agressive
+u8 frameSkip[4] __attribute__((section(".dtcm"))) = {0xFF, 0x03, 0x01, 0xFF};   // Frameskip OFF, Light, Agressive, Auto (set frame-by-frame in colecoDS_main)
 
 u16 tms_num_lines  __attribute__((section(".dtcm"))) = TMS9918_LINES;
 u16 tms_start_line __attribute__((section(".dtcm"))) = TMS9918_START_LINE;
@@ -790,10 +1158,7 @@ ITCM_CODE byte Loop9918(void)
   extern void colecoUpdateScreen(void);
   register byte bIRQ = 0;  // No IRQ yet
   
-  if (myConfig.soundDriver)
-  {
-      processDirectAudio();
-  }
+  sound_emu_pos += sound_line_step;    // Sound chip writes are timestamped against this
 
   /* Increment scanline */
   if (++CurLine >= tms_num_lines) CurLine=0;
@@ -803,7 +1168,19 @@ ITCM_CODE byte Loop9918(void)
   {
 #ifndef ZEXALL_TEST      
       unsigned int tmp;
-      if ((frameSkipIdx & frameSkip[myConfig.frameSkip]) == 0)
+      if (CurLine == tms_start_line) SelectSink9918();   // Frame blending may have been toggled in the options
+      if (myConfig.vdpRender == VDP_RENDER_DEFERRED)
+      {
+          // Render nothing now... just start the write log on the first line if we are going to show this frame
+          if (CurLine == tms_start_line)
+          {
+              vdp_log_len  = 0;
+              vdp_log_line = 0;
+              if (frameSkipIdx & frameSkip[myConfig.frameSkip]) vdp_log_active |= VDP_LOG_DEFERRED;
+          }
+          ScanSprites(CurLine - tms_start_line, &tmp);    // Still scan sprites for the 5th sprite flag as the CPU may be polling it
+      }
+      else if ((frameSkipIdx & frameSkip[myConfig.frameSkip]) == 0)
           ScanSprites(CurLine - tms_start_line, &tmp);    // Skip rendering - but still scan sprites for the 5th sprite flag
       else
           RefreshLine(CurLine - tms_start_line);
@@ -834,12 +1211,25 @@ ITCM_CODE byte Loop9918(void)
       // --------------------------------------------------------------------
       if ((myGlobalConfig.showFPS != 2) && (myConfig.vertSync))   // If not full speed we can try vertical sync if enabled
       {
+          u16 waitStart = TIMER2_DATA;
           swiWaitForVBlank();
+          vsync_wait_ticks = TIMER2_DATA - waitStart;   // The auto frameskip doesn't count this as work
       }
+      else vsync_wait_ticks = 0;
       
+      /* Render the whole deferred frame in one batch */
+      if (vdp_log_active & VDP_LOG_DEFERRED)
+      {
+          Flush9918(tms_end_line - tms_start_line);
+          vdp_log_active &= ~VDP_LOG_DEFERRED;
+      }
+
+      if (vdp_log_active & VDP_LOG_CAPTURE) VDPCapture(VDP_CAP_FRAME, 0);
+
       /* Refresh screen */
       if ((frameSkipIdx & frameSkip[myConfig.frameSkip]) != 0)
       {
+          if (myGlobalConfig.debugger == 3) vdp_frame_crc = getCRC32(XBuf, 256*192);
           colecoUpdateScreen();
       }
 
@@ -883,6 +1273,8 @@ ITCM_CODE byte Loop6502(void)
   /* No IRQ yet */
   bIRQ=0;
 
+  sound_emu_pos += sound_line_step;    // Sound chip writes are timestamped against this
+
   /* Increment scanline */
   if (++CurLine >= tms_num_lines) CurLine=0;
 
@@ -890,17 +1282,21 @@ ITCM_CODE byte Loop6502(void)
   if ((CurLine >= tms_start_line) && (CurLine < tms_end_line))
   {
       unsigned int tmp;
+      if (CurLine == tms_start_line) SelectSink9918();   // Frame blending may have been toggled in the options
       if ((frameSkipIdx & frameSkip[myConfig.frameSkip]) == 0)
           ScanSprites(CurLine - tms_start_line, &tmp);    // Skip rendering - but still scan sprites for the 5th sprite flag
       else
-         (SCR[ScrMode].Refresh)(CurLine - tms_start_line);
+          RefreshLine(CurLine - tms_start_line);
   }
   /* If time for emulated VBlank... */
   else if (CurLine == tms_end_line)
   {
+      if (vdp_log_active & VDP_LOG_CAPTURE) VDPCapture(VDP_CAP_FRAME, 0);
+
       /* Refresh screen */
       if ((frameSkipIdx & frameSkip[myConfig.frameSkip]) != 0)
       {
+          if (myGlobalConfig.debugger == 3) vdp_frame_crc = getCRC32(XBuf, 256*192);
           colecoUpdateScreen();
       }
 
@@ -970,12 +1366,18 @@ void Reset9918(void)
     
     BG_PALETTE[0] = RGB15(0x00,0x00,0x00);
     
-    pVidFlipBuf = (u16*) (0x06000000);    // Video flipping buffer
+    pVidFlipBuf = VDP_SINK_BG3;           // Video flipping buffer
+    vdp_sink = 0xFF;                      // Set up the frame sink again on the first frame
     
-    RefreshLine = RefreshLine0;
+    SelectRefresh9918();                // Display is off after reset
 
     OH = IH = 0;
     
+    InvalidateTextCache();              // Nothing drawn in text mode yet
+    ResetLog9918();                     // No deferred VDP writes pending
+    vdp_dirty = VDP_DIRTY_FRAMES;       // Make sure the next frames are shown
+    vdp_changed = 1;                    // Don't reuse any cached line work
+    
     // ------------------------------------------------------------
     // Determine if we are PAL vs NTSC and adjust line timing...
     // ------------------------------------------------------------
@@ -56,10 +56,22 @@
 
 typedef struct {
   void (*Refresh)(u8 uY);
+  void (*RefreshM)(u8 uY);
   byte R2,R3,R4,R5,R6,M2,M3,M4,M5;
 } tScrMode;
 
+// ---------------------------------------------------------------------------------------
+// Where the frame sink puts the picture - the BG3 bitmap and, for FRAME_BLEND_LAYERS, the
+// BG2 bitmap right after it. A host build defines these to its own memory instead.
+// ---------------------------------------------------------------------------------------
+#ifndef VDP_SINK_BG3
+#define VDP_SINK_BG3        ((u16*)0x06000000)
+#define VDP_SINK_BG2        ((u16*)0x06010000)
+#endif
+
 extern u8 *XBuf;
+extern u8 vdp_sink;                            // FRAME_BLEND_xxx the frame sink is set up for
+extern u32 vdp_dirty_rows[192/32];             // One bit per row of XBuf changed since it last went to the display
 extern u8 XBuf_A[];
 extern u8 XBuf_B[];
 extern u8 OH;
@@ -73,9 +85,16 @@ extern tScrMode SCR[MAXSCREEN+1];
 extern void RefreshLine0(u8 uY);
 extern void RefreshLine1(u8 uY);
 extern void RefreshLine2(u8 uY);
+extern void RefreshLine2M(u8 uY);
 extern void RefreshLine3(u8 uY);
+extern void RefreshLineOff(u8 uY);
+extern void (*RefreshLine)(u8 uY);             // The renderer for the current screen mode
+extern void SelectRefresh9918(void);
+extern void InvalidateTextCache(void);
+extern void SelectSink9918(void);
 
 extern byte WrCtrl9918(byte value);
+extern byte Write9918(u8 iReg, u8 value);
 extern u8 pVDPVidMem[];
 
 extern byte RdData9918(void);
@@ -92,11 +111,28 @@ extern u8 ScrMode;                             // Current screen mode
 extern u8 FGColor,BGColor;                     // Colors
 extern u16 ColTabM, ChrGenM;                   // Color and Character Masks
 
+#define VDP_LOG_SIZE        2048                // Deferred rendering write log entries
+#define VDP_LOG_REGISTER    0x8000              // Set in the log address field for a VDP register write
+#define VDP_LOG_DEFERRED    0x01                // vdp_log_active bit - logging writes for deferred rendering
+#define VDP_LOG_CAPTURE     0x02                // vdp_log_active bit - recording port accesses to a capture file
+
+#define VDP_DIRTY_FRAMES    4                   // Frames to keep refreshing after a change (covers blending two half-updated frames)
+
+extern u8 vdp_dirty;                           // Frames left to show - set from vdp_changed once per frame
+extern u8 vdp_changed;                         // Set (to 1) by any VRAM or VDP register write - folded into vdp_dirty once per frame
+extern u32 vdp_frame_crc;                      // CRC32 of the last rendered frame (full debugger only)
+extern u8 vdp_log_active;                      // VDP_LOG_xxx bits set when VDP accesses are being logged
+extern void LogWrite9918(u16 addr, u8 oldVal, u8 newVal);
+extern void ResetLog9918(void);
+extern void WrBlock9918(const u8 *src, u16 len);
+
 /** WrData9918() *********************************************/
 /** Write a value V to the VDP Data Port.                   **/
 /*************************************************************/
 inline __attribute__((always_inline)) void WrData9918(byte V)  // This one is used frequently so we always inline it
 {
+    if (vdp_log_active) LogWrite9918(VAddr, pVDPVidMem[VAddr], V);  // Only during the visible part of a deferred frame or a capture
+    vdp_changed = 1;
     VDPDlatch = pVDPVidMem[VAddr] = V;
     VAddr     = (VAddr+1)&0x3FFF;
     VDPCtrlLatch = 0;
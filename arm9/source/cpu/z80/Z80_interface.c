@@ -24,12 +24,14 @@
 #include "../../Adam.h"
 #include "../../C24XX.h"
 #include "../../printf.h"
+#include "../../pagedrom.h"
 #include "../scc/SCC.h"
 
 u8  last_mega_bank     __attribute__((section(".dtcm"))) = 199;
 u8  msx_sram_at_8000   __attribute__((section(".dtcm"))) = 0;
 u8  msx_scc_enable     __attribute__((section(".dtcm"))) = 0;
 u8  msx_last_block[4]  __attribute__((section(".dtcm"))) = {99,99,99,99};
+u8 *simplified_bank    __attribute__((section(".dtcm"))) = RAM_Memory + 0xC000; // Mega Cart window for the banked simplified driver
 
 // ---------------------------------------------------------------
 // Switch banks... do this as fast as possible by switching only
@@ -51,6 +53,8 @@ ITCM_CODE void MegaCartBankSwitch(u8 bank)
 // handles the RAM_Memory[] as a flat 64K address space. To make this work
 // for banked games, we must actually swap in the memory by memcpy(). Not
 // the fastest, but fortunately many Megacarts do very little swapping...
+// The banked variant of that driver reads 0xC000-0xFFFF through
+// simplified_bank instead so we only have to point it at the new bank.
 // ------------------------------------------------------------------------
 ITCM_CODE void MegaCartBankSwap(u8 bank)
 {
@@ -61,7 +65,12 @@ ITCM_CODE void MegaCartBankSwap(u8 bank)
         {
             MemoryMap[6] = ROM_Memory + ((u32)bank * (u32)0x4000);
             MemoryMap[7] = MemoryMap[6] + 0x2000;
-            if (bank < 16) // First 256K of the ROM is in shadow VRAM for speed
+            if (bSuperSimplifiedMemory == 2)
+            {
+                if (bank < 16) simplified_bank = ((u8*)0x06860000) + ((u32)bank * (u32)0x4000);
+                else simplified_bank = MemoryMap[6];
+            }
+            else if (bank < 16) // First 256K of the ROM is in shadow VRAM for speed
             {
                 //memcpy(RAM_Memory + 0xC000, ((u8*)0x06860000) + ((u32)bank * (u32)0x4000), 0x4000);
                 u32 *src = (u32 *) (((u8*)0x06860000) + ((u32)bank * (u32)0x4000));
@@ -81,17 +90,137 @@ ITCM_CODE void MegaCartBankSwap(u8 bank)
 }
 
 // ----------------------------------------------------------------------
-// Here we might have a very large ROM and we don't expect much swapping
-// so we will just re-read the file and pull in the correct 32K bank...
+// Here we might have a very large ROM (the 31-in-1 and 63-in-1 carts are
+// 1MB and 2MB) so rather than hold it all in memory we pull in the 32K
+// bank from the file. To keep the SD card out of the emulation loop we
+// hold on to the most recently used banks in a small cache - on the DSi
+// the spare 2MB buffer holds every bank of even the 63-in-1 cart, on the
+// DS-Lite/Phat we borrow the 256K of LCD VRAM at 0x06860000 (8 banks)
+// that the simplified driver otherwise uses. The least recently used
+// bank is the one that gets thrown out when we need room.
 // ----------------------------------------------------------------------
+#define BANK_CACHE_MAX_SLOTS    64
+#define BANK_CACHE_EMPTY        0xFF
+#define BANK_CACHE_CHUNK        0x1000      // Prefetch is done in 4K pieces so it never costs us a frame
+
+static FILE *bank_cache_file = NULL;                        // Kept open so a miss is just a seek and read
+static u8   *bank_cache_mem = NULL;                         // Start of the slot memory (DSi RAM or LCD VRAM)
+static u8    bank_cache_slots = 0;                          // How many 32K slots we have
+static u8    bank_cache_bank[BANK_CACHE_MAX_SLOTS];         // Which bank each slot holds (or BANK_CACHE_EMPTY)
+static u32   bank_cache_used[BANK_CACHE_MAX_SLOTS];         // When each slot was last used - for the LRU
+static u32   bank_cache_clock = 0;
+static u8    bank_cache_prefetch_bank = 0;                  // Next bank the idle prefetch will look at
+static u8    bank_cache_prefetch_slot = BANK_CACHE_EMPTY;   // Slot being filled by the prefetch (if any)
+static u16   bank_cache_prefetch_pos = 0;                   // How much of that slot has been filled so far
+static u8    bank_cache_chunk[BANK_CACHE_CHUNK] __attribute__((aligned(4)));
+u32          bank_cache_hits = 0;
+u32          bank_cache_misses = 0;
+
+void Mega31in1CacheClose(void)
+{
+    if (bank_cache_file) fclose(bank_cache_file);
+    bank_cache_file = NULL;
+    bank_cache_slots = 0;
+}
+
+void Mega31in1CacheInit(void)
+{
+    Mega31in1CacheClose();
+    bank_cache_file = fopen(disk_last_file[0], "rb");
+
+    if (DSI_RAM_Buffer) {bank_cache_mem = DSI_RAM_Buffer;      bank_cache_slots = (2*1024*1024) / 0x8000;}
+    else                {bank_cache_mem = (u8*) (0x06860000);  bank_cache_slots = (256*1024) / 0x8000;}
+    if (bank_cache_slots > (romBankMask+1)) bank_cache_slots = (romBankMask+1);
+
+    memset(bank_cache_bank, BANK_CACHE_EMPTY, sizeof(bank_cache_bank));
+    memset(bank_cache_used, 0x00, sizeof(bank_cache_used));
+    bank_cache_clock = 0;
+    bank_cache_prefetch_bank = 0;
+    bank_cache_prefetch_slot = BANK_CACHE_EMPTY;
+    bank_cache_prefetch_pos = 0;
+    bank_cache_hits = 0;
+    bank_cache_misses = 0;
+}
+
 void Mega31in1BankSwitch(u8 bank)
 {
-    FILE* handle = fopen(disk_last_file[0], "rb");
-    if (handle != NULL) 
+    u8 slot, victim = 0;
+
+    if (!bank_cache_file) return;
+
+    for (slot=0; slot<bank_cache_slots; slot++)
+    {
+        if (bank_cache_bank[slot] == bank) break;
+        if (bank_cache_used[slot] < bank_cache_used[victim]) victim = slot;
+    }
+
+    if (slot < bank_cache_slots)    // Cache hit - just a fast copy from the slot
     {
-        fseek(handle, (0x8000 * (u32)bank), SEEK_SET);          // Seek to the 32K chunk we want to read in
-        fread((void*) RAM_Memory+0x8000, 0x8000, 1, handle);    // Read 32K from that paged block
-        fclose(handle);
+        memcpy(RAM_Memory+0x8000, bank_cache_mem + ((u32)slot * 0x8000), 0x8000);
+        bank_cache_hits++;
+    }
+    else                            // Cache miss - read the bank from the file and keep a copy in the LRU slot
+    {
+        fseek(bank_cache_file, (0x8000 * (u32)bank), SEEK_SET);        // Seek to the 32K chunk we want to read in
+        u32 len = fread((void*) RAM_Memory+0x8000, 1, 0x8000, bank_cache_file);   // Read 32K from that paged block
+        if (len < 0x8000) memset(RAM_Memory+0x8000+len, 0xFF, 0x8000-len);     // Past the end of the file - unmapped reads back as 0xFF
+        if ((victim == bank_cache_prefetch_slot) || (bank == bank_cache_prefetch_bank)) bank_cache_prefetch_slot = BANK_CACHE_EMPTY;
+        memcpy(bank_cache_mem + ((u32)victim * 0x8000), RAM_Memory+0x8000, 0x8000);
+        bank_cache_bank[victim] = bank;
+        slot = victim;
+        bank_cache_misses++;
+    }
+    bank_cache_used[slot] = ++bank_cache_clock;
+}
+
+// ----------------------------------------------------------------------
+// There is no asynchronous file I/O to be had here, so the next best
+// thing is to fill empty slots a little at a time - we read one 4K
+// piece per frame until the slot is full. We never evict for this.
+// ----------------------------------------------------------------------
+void Mega31in1Prefetch(void)
+{
+    if (!bank_cache_file) return;
+
+    if (bank_cache_prefetch_slot == BANK_CACHE_EMPTY)  // Find the next bank that isn't cached and a free slot for it
+    {
+        u8 free_slot = BANK_CACHE_EMPTY;
+        for (u8 slot=0; slot<bank_cache_slots; slot++)
+        {
+            if (bank_cache_bank[slot] == BANK_CACHE_EMPTY) {free_slot = slot; break;}
+        }
+        if (free_slot == BANK_CACHE_EMPTY) return;      // Cache is full - nothing more to do
+
+        for (u8 tries=0; tries <= romBankMask; tries++)
+        {
+            u8 bank = bank_cache_prefetch_bank++ & romBankMask, found = 0;
+            for (u8 slot=0; slot<bank_cache_slots; slot++)
+            {
+                if (bank_cache_bank[slot] == bank) {found = 1; break;}
+            }
+            if (!found)
+            {
+                bank_cache_prefetch_slot = free_slot;
+                bank_cache_prefetch_pos = 0;
+                bank_cache_prefetch_bank = bank;
+                break;
+            }
+        }
+        if (bank_cache_prefetch_slot == BANK_CACHE_EMPTY) return;
+    }
+
+    // Read the next piece into a bounce buffer (LCD VRAM doesn't like the byte writes a read can do)
+    fseek(bank_cache_file, (0x8000 * (u32)bank_cache_prefetch_bank) + bank_cache_prefetch_pos, SEEK_SET);
+    u32 len = fread(bank_cache_chunk, 1, BANK_CACHE_CHUNK, bank_cache_file);
+    if (len < BANK_CACHE_CHUNK) memset(bank_cache_chunk + len, 0xFF, BANK_CACHE_CHUNK - len);
+    memcpy(bank_cache_mem + ((u32)bank_cache_prefetch_slot * 0x8000) + bank_cache_prefetch_pos, bank_cache_chunk, BANK_CACHE_CHUNK);
+    bank_cache_prefetch_pos += BANK_CACHE_CHUNK;
+
+    if (bank_cache_prefetch_pos >= 0x8000)              // Slot is full - it now holds a valid bank
+    {
+        bank_cache_bank[bank_cache_prefetch_slot] = bank_cache_prefetch_bank++;
+        bank_cache_used[bank_cache_prefetch_slot] = 0;  // Not used yet so it's the first to go if we need room
+        bank_cache_prefetch_slot = BANK_CACHE_EMPTY;
     }
 }
 
@@ -153,6 +282,16 @@ ITCM_CODE u8 cpu_readmem16_banked(u16 address)
 }
 
 
+// -----------------------------------------------------------------------
+// A demand-paged ROM has to find (or read in) the frame holding the bank
+// but only once a slot really switches to it - most mapper writes select
+// the bank that is already there and those never touch the page pool.
+// -----------------------------------------------------------------------
+static inline __attribute__((always_inline)) u32 *MSXBankSrc(u32 *src, u32 block)
+{
+    return (paged_rom ? (u32*)PagedROMBank(block) : src);
+}
+
 // -----------------------------------------------------------------------
 // Zemina 8K mapper:
 //Page (8kB)    Switching address   Initial segment
@@ -167,6 +306,7 @@ void HandleZemina8K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[0] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[2] = (u8*)src;  // Main ROM
             MSXCartPtr[6] = (u8*)src;  // Mirror
             MemoryMap[2] = (u8 *)(MSXCartPtr[2]);
@@ -177,6 +317,7 @@ void HandleZemina8K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[1] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[3] = (u8*)src;  // Main ROM
             MSXCartPtr[7] = (u8*)src;  // Mirror
             MemoryMap[3] = (u8 *)(MSXCartPtr[3]);
@@ -187,6 +328,7 @@ void HandleZemina8K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[2] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[4] = (u8*)src;  // Main ROM
             MSXCartPtr[0] = (u8*)src;  // Mirror                            
             MemoryMap[4] = (u8 *)(MSXCartPtr[4]);
@@ -197,6 +339,7 @@ void HandleZemina8K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[3] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[5] = (u8*)src;  // Main ROM
             MSXCartPtr[1] = (u8*)src;  // Mirror                            
             MemoryMap[5] = (u8 *)(MSXCartPtr[5]);
@@ -216,6 +359,7 @@ void HandleZemina16K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[0] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[2] = (u8*)src;
             MSXCartPtr[3] = (u8*)src+0x2000;
             MemoryMap[2] = (u8 *)(MSXCartPtr[2]);
@@ -235,6 +379,7 @@ void HandleZemina16K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[1] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[4] = (u8*)src;
             MSXCartPtr[5] = (u8*)src+0x2000;
             // Mirrors
@@ -268,6 +413,7 @@ ITCM_CODE void HandleKonamiSCC8(u32* src, u8 block, u16 address, u8 value)
     {
         if (msx_last_block[0] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[2] = (u8*)src;  // Main ROM
             MSXCartPtr[6] = (u8*)src;  // Mirror
             MemoryMap[2] = (u8 *)(MSXCartPtr[2]);
@@ -278,6 +424,7 @@ ITCM_CODE void HandleKonamiSCC8(u32* src, u8 block, u16 address, u8 value)
     {
         if (msx_last_block[1] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[3] = (u8*)src;  // Main ROM
             MSXCartPtr[7] = (u8*)src;  // Mirror
             MemoryMap[3] = (u8 *)(MSXCartPtr[3]);
@@ -290,6 +437,7 @@ ITCM_CODE void HandleKonamiSCC8(u32* src, u8 block, u16 address, u8 value)
 
         if (msx_last_block[2] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[4] = (u8*)src;  // Main ROM
             MSXCartPtr[0] = (u8*)src;  // Mirror
             MemoryMap[4] = (u8 *)(MSXCartPtr[4]);
@@ -300,6 +448,7 @@ ITCM_CODE void HandleKonamiSCC8(u32* src, u8 block, u16 address, u8 value)
     {
         if (msx_last_block[3] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[5] = (u8*)src;  // Main ROM
             MSXCartPtr[1] = (u8*)src;  // Mirror
             MemoryMap[5] = (u8 *)(MSXCartPtr[5]);
@@ -320,6 +469,7 @@ ITCM_CODE void HandleAscii16K(u32* src, u8 block, u16 address)
     {
         if (msx_last_block[0] != block)
         {
+            src = MSXBankSrc(src, block);
             MSXCartPtr[2] = (u8*)src;
             MSXCartPtr[3] = (u8*)src+0x2000;
             MemoryMap[2] = MSXCartPtr[2];
@@ -352,6 +502,7 @@ ITCM_CODE void HandleAscii16K(u32* src, u8 block, u16 address)
             else
             {
                 msx_sram_at_8000 = false;
+                src = MSXBankSrc(src, block);
                 MSXCartPtr[4] = (u8*)src;
                 MSXCartPtr[5] = (u8*)src+0x2000;
                 // Mirrors
@@ -425,12 +576,15 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
             // $fffd 0 ($0000-$3fff)
             // $fffe 1 ($4000-$7fff)
             // $ffff 2 ($8000-$bfff)
+            // The two 8K pages of the slot are pointed straight at the
+            // ROM bank - writes to the slot still land in RAM_Memory[]
+            // which is never read back while a bank is mapped there.
             // -------------------------------------------------------
             if (sg1000_sms_mapper && (address >= 0xFFFD))
             {
-                if      (address == 0xFFFD) memcpy(RAM_Memory+0x0000, ROM_Memory+((u32)(value&sg1000_sms_mapper)*16*1024), 0x4000);
-                else if (address == 0xFFFE) memcpy(RAM_Memory+0x4000, ROM_Memory+((u32)(value&sg1000_sms_mapper)*16*1024), 0x4000);
-                else if (address == 0xFFFF) memcpy(RAM_Memory+0x8000, ROM_Memory+((u32)(value&sg1000_sms_mapper)*16*1024), 0x4000);
+                u8 page = (address - 0xFFFD) << 1;
+                MemoryMap[page]   = ROM_Memory + ((u32)(value&sg1000_sms_mapper) * (u32)0x4000);
+                MemoryMap[page+1] = MemoryMap[page] + 0x2000;
             }
 
             // Allow normal SG-1000, SC-3000 writes, plus allow for 8K RAM Expanders...
@@ -483,7 +637,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                     // -------------------------------------------------------------
                     u32 block = (value & mapperMask);
                     u32 msx_offset = block * msx_block_size;
-                    u32 *src = (u32*)((u8*)ROM_Memory + msx_offset);
+                    u32 *src = (u32*)((u8*)ROM_Memory + msx_offset);   // Flat ROM - a paged ROM looks up its frame only when a slot switches
 
                     // ---------------------------------------------------------------------------------
                     // The Konami 8K Mapper without SCC:
@@ -498,6 +652,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[0] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[2] = (u8*)src;  // Main ROM
                                 MSXCartPtr[6] = (u8*)src;  // Mirror
                                 MemoryMap[2] = (u8 *)(MSXCartPtr[2]);
@@ -508,6 +663,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[1] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[3] = (u8*)src;  // Main ROM
                                 MSXCartPtr[7] = (u8*)src;  // Mirror
                                 MemoryMap[3] = (u8 *)(MSXCartPtr[3]);
@@ -518,6 +674,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[2] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[4] = (u8*)src;  // Main ROM
                                 MSXCartPtr[0] = (u8*)src;  // Mirror                            
                                 MemoryMap[4] = (u8 *)(MSXCartPtr[4]);
@@ -528,6 +685,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[3] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[5] = (u8*)src;  // Main ROM
                                 MSXCartPtr[1] = (u8*)src;  // Mirror       
                                 MemoryMap[5] = (u8 *)(MSXCartPtr[5]);
@@ -548,6 +706,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[0] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[2] = (u8*)src;  // Main ROM
                                 MSXCartPtr[6] = (u8*)src;  // Mirror
                                 MemoryMap[2] = MSXCartPtr[2];
@@ -562,6 +721,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                         {
                             if (msx_last_block[1] != block)
                             {
+                                src = MSXBankSrc(src, block);
                                 MSXCartPtr[3] = (u8*)src;  // Main ROM
                                 MSXCartPtr[7] = (u8*)src;  // Mirror
                                 MemoryMap[3] = MSXCartPtr[3];
@@ -583,6 +743,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                                 else
                                 {
                                     msx_sram_at_8000 = false;
+                                    src = MSXBankSrc(src, block);
                                     MSXCartPtr[4] = (u8*)src;  // Main ROM
                                     MSXCartPtr[0] = (u8*)src;  // Mirror    
                                     if (bROMInSegment[2])
@@ -608,6 +769,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                                 else
                                 {
                                     msx_sram_at_8000 = false;
+                                    src = MSXBankSrc(src, block);
                                     MSXCartPtr[5] = (u8*)src;  // Main ROM
                                     MSXCartPtr[1] = (u8*)src;  // Mirror                            
                                     if (bROMInSegment[2]) 
@@ -632,7 +794,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                             // ----------------------------------------------------
                             if (msx_scc_enable && ((address & 0xFF00)==0x9800))
                             {
-                                 SCCWrite(value, address, &mySCC);
+                                 SoundWriteSCC(value, address);
                             }
                             return;    // It has to be one of the mapped addresses below - this will also short-circuit any SCC writes which are not yet supported
                         }
@@ -654,6 +816,7 @@ ITCM_CODE void cpu_writemem16(u8 value,u16 address)
                     {
                         if (address == 0x4045)
                         {
+                            src = MSXBankSrc(src, block);
                             MSXCartPtr[4] = (u8*)src;          // Main ROM at 8000
                             MSXCartPtr[5] = (u8*)src+0x2000;   // Main ROM at A000                  
                             if (bROMInSegment[2]) 
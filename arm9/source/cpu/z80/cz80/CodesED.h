@@ -177,6 +177,38 @@ case OUTI:
   break;
 
 case OTIR:
+  if (IsVDPDataPort(CPU.BC.W))
+  {
+    // ------------------------------------------------------------------------
+    // Tile uploads to the VDP are almost always OTIR loops. Interrupts are only
+    // taken once ExecZ80() gives up its time slice, so we can burst every pass
+    // that would have run before then straight into VRAM and charge the same
+    // cycles - the VDP sees exactly the same stream of writes.
+    // ------------------------------------------------------------------------
+    u8  buf[256];
+    u16 cost = CyclesED[OTIR] + ED_PREFIX_CYCLES;
+    u16 num  = (CPU.BC.B.h ? CPU.BC.B.h : 256);
+    u16 k    = 1;
+    if (CPU.ICount > 0) k += (CPU.ICount + cost - 1) / cost;
+    if (k > num) k = num;
+    for (u16 n=0; n<k; n++) buf[n] = RdZ80(CPU.HL.W++);
+    WrBlock9918(buf, k);
+    CPU.BC.B.h -= k;
+    CPU.ICount -= (k-1) * cost;
+    ED_REPEAT_R(k-1);
+    I = buf[k-1];
+    if(CPU.BC.B.h)
+    {
+      CPU.AF.B.l=N_FLAG|(CPU.HL.B.l+I>255? (C_FLAG|H_FLAG):0);
+      CPU.PC.W-=2;
+    }
+    else
+    {
+      CPU.AF.B.l=(CPU.AF.B.l & S_FLAG) | Z_FLAG | (I&0x80 ? N_FLAG:0) | (CPU.HL.B.l+I>255? (C_FLAG|H_FLAG):0);
+      CPU.ICount+=5;
+    }
+    break;
+  }
   --CPU.BC.B.h;
   I=RdZ80(CPU.HL.W++);
   OutZ80(CPU.BC.W,I);
@@ -75,6 +75,9 @@ inline byte RdZ80(word A)   {return RAM_Memory[A];}
 #define     OutZ80(P,V)      cpu_writeport16(P,V)
 #define     InZ80(P)         cpu_readport16(P)
 
+extern u8   IsVDPDataPort(unsigned short Port);
+extern void WrBlock9918(const u8 *src, u16 len);
+
 /** Macros for use through the CPU subsystem */
 #define S(Fl)        CPU.AF.B.l|=Fl
 #define R(Fl)        CPU.AF.B.l&=~(Fl)
@@ -399,6 +402,13 @@ static void CodesFDCB(void)
 #undef XX
 }
 
+// ---------------------------------------------------------------------------
+// When a block instruction is burst in CodesED.h, every extra pass costs the
+// ED prefix as well as its own cycles and bumps R for both M1 cycles.
+// ---------------------------------------------------------------------------
+#define ED_PREFIX_CYCLES (M1_Wait ? Cycles[PFX_ED] : Cycles_NoM1Wait[PFX_ED])
+#define ED_REPEAT_R(N)   CPU.R += 2*(N)
+
 static void CodesED(void)
 {
   register byte I;
@@ -652,10 +662,9 @@ ITCM_CODE void IntZ80(Z80 *R,word Vector)
 // =====================================================================
 extern void MegaCartBankSwap(u8 bank);
 extern void WrZ80f(word address, byte data);
+extern u8 *simplified_bank;
 inline __attribute__((always_inline)) byte RdZ80f(word A)   {if (A>=0xFFC0) MegaCartBankSwap(A); return RAM_Memory[A];}
 
-#define  OpZ80(A)   RAM_Memory[A]
-#define  RdZ80      RdZ80f
 #undef   WrZ80
 
 inline __attribute__((always_inline)) void WrZ80(word address, byte data)
@@ -669,179 +678,38 @@ inline __attribute__((always_inline)) void WrZ80(word address, byte data)
     }
 }
 
-
-static void CodesCB_Simplified(void)
-{
-  register byte I;
-
-  /* Read opcode and count cycles */
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesCB[I];
-
-  switch(I)
-  {
-#include "CodesCB.h"
-    default:
-      if(CPU.TrapBadOps)  Trap_Bad_Ops(" CB ", I, CPU.PC.W-2);
-  }
-}
-
-static void CodesDDCB_Simplified(void)
-{
-  register pair J;
-  register byte I;
-
-#define XX IX
-  /* Get offset, read opcode and count cycles */
-  J.W=CPU.XX.W+(offset)OpZ80(CPU.PC.W++);
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesXXCB[I];
-
-  switch(I)
-  {
-#include "CodesXCB.h"
-    default:
-      if(CPU.TrapBadOps)  Trap_Bad_Ops("DDCB", I, CPU.PC.W-4);
-  }
-#undef XX
-}
-
-static void CodesFDCB_Simplified(void)
-{
-  register pair J;
-  register byte I;
-
-#define XX IY
-  /* Get offset, read opcode and count cycles */
-  J.W=CPU.XX.W+(offset)OpZ80(CPU.PC.W++);
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesXXCB[I];
-
-  switch(I)
-  {
-#include "CodesXCB.h"
-    default:
-      if(CPU.TrapBadOps)  Trap_Bad_Ops("FDCB", I, CPU.PC.W-4);
-  }
-#undef XX
-}
-
-static void CodesED_Simplified(void)
-{
-  register byte I;
-  register pair J;
-
-  /* Read opcode and count cycles */
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesED[I];
-
-  switch(I)
-  {
-#include "CodesED.h"
-    case PFX_ED:
-      CPU.PC.W--;break;
-    default:
-      if(CPU.TrapBadOps) Trap_Bad_Ops(" ED ", I, CPU.PC.W-4);
-  }
-}
-
-static void CodesDD_Simplified(void)
-{
-  register byte I;
-  register pair J;
-
-#define XX IX
-  /* Read opcode and count cycles */
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesXX[I];
-
-  switch(I)
-  {
-#include "CodesXX.h"
-    case PFX_FD:
-    case PFX_DD:
-      CPU.PC.W--;break;
-    case PFX_CB:
-      CodesDDCB_Simplified();break;
-    default:
-      if(CPU.TrapBadOps)  Trap_Bad_Ops(" DD ", I, CPU.PC.W-2);
-  }
-#undef XX
-}
-
-static void CodesFD_Simplified(void)
-{
-  register byte I;
-  register pair J;
-
-#define XX IY
-  /* Read opcode and count cycles */
-  I=OpZ80(CPU.PC.W++);
-  CPU.ICount-=CyclesXX[I];
-
-  switch(I)
-  {
-#include "CodesXX.h"
-    case PFX_FD:
-    case PFX_DD:
-      CPU.PC.W--;break;
-    case PFX_CB:
-      CodesFDCB_Simplified();break;
-    default:
-        if(CPU.TrapBadOps)  Trap_Bad_Ops(" FD ", I, CPU.PC.W-2);
-  }
-#undef XX
-}
-
-
-int ExecZ80_Simplified(register int RunCycles)
+// ---------------------------------------------------------------------
+// The flat model - everything, including the Mega Cart bank at 0xC000,
+// is read straight out of RAM_Memory[] (banks are copied in on a swap).
+// ---------------------------------------------------------------------
+#define  OpZ80(A)   RAM_Memory[A]
+#define  RdZ80      RdZ80f
+#define  SIMPLIFIED(name) name##_Simplified
+#include "Z80Simplified.h"
+#undef   SIMPLIFIED
+#undef   RdZ80
+#undef   OpZ80
+
+// ---------------------------------------------------------------------
+// The banked model - the 16K Mega Cart window at 0xC000 is read through
+// simplified_bank so a bank switch is just a pointer change. Costs one
+// compare per access but never a 16K copy.
+// ---------------------------------------------------------------------
+inline __attribute__((always_inline)) byte OpZ80b(word A)   {return ((A>=0xC000) ? simplified_bank[A&0x3FFF] : RAM_Memory[A]);}
+inline __attribute__((always_inline)) byte RdZ80b(word A)
 {
-  register byte I;
-  register pair J;
-
-  for(CPU.ICount=RunCycles;;)
-  {
-    while(CPU.ICount>0)
+    if (A>=0xC000)
     {
-      /* Read opcode and count cycles */
-      I=OpZ80(CPU.PC.W++);
-      CPU.ICount-=Cycles[I];
-
-      /* Interpret opcode */
-      switch(I)
-      {
-#include "Codes.h"
-        case PFX_CB: CodesCB_Simplified();break;
-        case PFX_ED: 
-          if (OpZ80(CPU.PC.W) == 0xA3) // This is so common so we trap it here to avoid the slow function call overhead
-          {   //A3 is OUTI
-              CPU.PC.W++;
-              CPU.ICount-=16;
-              --CPU.BC.B.h;
-              I=RdZ80(CPU.HL.W++);
-              OutZ80(CPU.BC.W,I);
-              CPU.AF.B.l=(CPU.BC.B.h? 0:Z_FLAG)|(CPU.HL.B.l+I>255? (C_FLAG|H_FLAG):0);
-          }
-          else CodesED_Simplified();
-          break;
-        case PFX_FD: CodesFD_Simplified();break;
-        case PFX_DD: CodesDD_Simplified();break;
-      }
-    }
-    
-    /* Normally the R register would be incremented on every M1 CPU access... but for the optimized driver, we just increment it per scanline */
-    INCR(1);
-
-    /* Unless we have come here after EI, exit */
-    if(!(CPU.IFF&IFF_EI)) return(CPU.ICount);
-    else
-    {
-      /* Done with AfterEI state */
-      CPU.IFF=(CPU.IFF&~IFF_EI)|IFF_1;
-      /* Restore the ICount */
-      CPU.ICount+=CPU.IBackup-1;
-      /* Interrupt CPU if needed */
-      if((CPU.IRequest!=INT_NONE)&&(CPU.IRequest!=INT_QUIT)) IntZ80(&CPU,CPU.IRequest);
+        if (A>=0xFFC0) MegaCartBankSwap(A);
+        return simplified_bank[A&0x3FFF];
     }
-  }
+    return RAM_Memory[A];
 }
+
+#define  OpZ80      OpZ80b
+#define  RdZ80      RdZ80b
+#define  SIMPLIFIED(name) name##_SimplifiedBanked
+#include "Z80Simplified.h"
+#undef   SIMPLIFIED
+#undef   RdZ80
+#undef   OpZ80
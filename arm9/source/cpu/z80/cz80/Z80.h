@@ -121,6 +121,7 @@ void ResetZ80(register Z80 *R);
 #ifdef EXECZ80
 int ExecZ80(register int RunCycles);
 int ExecZ80_Simplified(register int RunCycles);
+int ExecZ80_SimplifiedBanked(register int RunCycles);
 #endif
 
 /** IntZ80() *************************************************/
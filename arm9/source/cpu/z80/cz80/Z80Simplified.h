@@ -0,0 +1,201 @@
+/******************************************************************************
+*  ColecoDS Z80 CPU 
+*
+* Note: Most of this file is from the ColEm emulator core by Marat Fayzullin
+*       but heavily modified for specific NDS use. If you want to use this
+*       code, you are advised to seek out the much more portable ColEm core
+*       and contact Marat.       
+*
+******************************************************************************/
+
+/** Z80: portable Z80 emulator *******************************/
+/**                                                         **/
+/**                      Z80Simplified.h                    **/
+/**                                                         **/
+/** This file contains the optimized DS-Lite/Phat executor. **/
+/** It is included by Z80.c once for each memory model with **/
+/** OpZ80(), RdZ80() and WrZ80() set up for that model and  **/
+/** SIMPLIFIED(name) giving the function names to use.      **/
+/*************************************************************/
+
+static void SIMPLIFIED(CodesCB)(void)
+{
+  register byte I;
+
+  /* Read opcode and count cycles */
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesCB[I];
+
+  switch(I)
+  {
+#include "CodesCB.h"
+    default:
+      if(CPU.TrapBadOps)  Trap_Bad_Ops(" CB ", I, CPU.PC.W-2);
+  }
+}
+
+static void SIMPLIFIED(CodesDDCB)(void)
+{
+  register pair J;
+  register byte I;
+
+#define XX IX
+  /* Get offset, read opcode and count cycles */
+  J.W=CPU.XX.W+(offset)OpZ80(CPU.PC.W++);
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesXXCB[I];
+
+  switch(I)
+  {
+#include "CodesXCB.h"
+    default:
+      if(CPU.TrapBadOps)  Trap_Bad_Ops("DDCB", I, CPU.PC.W-4);
+  }
+#undef XX
+}
+
+static void SIMPLIFIED(CodesFDCB)(void)
+{
+  register pair J;
+  register byte I;
+
+#define XX IY
+  /* Get offset, read opcode and count cycles */
+  J.W=CPU.XX.W+(offset)OpZ80(CPU.PC.W++);
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesXXCB[I];
+
+  switch(I)
+  {
+#include "CodesXCB.h"
+    default:
+      if(CPU.TrapBadOps)  Trap_Bad_Ops("FDCB", I, CPU.PC.W-4);
+  }
+#undef XX
+}
+
+// The simplified core always charges M1 waits and does not track R
+#undef  ED_PREFIX_CYCLES
+#undef  ED_REPEAT_R
+#define ED_PREFIX_CYCLES Cycles[PFX_ED]
+#define ED_REPEAT_R(N)
+
+static void SIMPLIFIED(CodesED)(void)
+{
+  register byte I;
+  register pair J;
+
+  /* Read opcode and count cycles */
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesED[I];
+
+  switch(I)
+  {
+#include "CodesED.h"
+    case PFX_ED:
+      CPU.PC.W--;break;
+    default:
+      if(CPU.TrapBadOps) Trap_Bad_Ops(" ED ", I, CPU.PC.W-4);
+  }
+}
+
+static void SIMPLIFIED(CodesDD)(void)
+{
+  register byte I;
+  register pair J;
+
+#define XX IX
+  /* Read opcode and count cycles */
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesXX[I];
+
+  switch(I)
+  {
+#include "CodesXX.h"
+    case PFX_FD:
+    case PFX_DD:
+      CPU.PC.W--;break;
+    case PFX_CB:
+      SIMPLIFIED(CodesDDCB)();break;
+    default:
+      if(CPU.TrapBadOps)  Trap_Bad_Ops(" DD ", I, CPU.PC.W-2);
+  }
+#undef XX
+}
+
+static void SIMPLIFIED(CodesFD)(void)
+{
+  register byte I;
+  register pair J;
+
+#define XX IY
+  /* Read opcode and count cycles */
+  I=OpZ80(CPU.PC.W++);
+  CPU.ICount-=CyclesXX[I];
+
+  switch(I)
+  {
+#include "CodesXX.h"
+    case PFX_FD:
+    case PFX_DD:
+      CPU.PC.W--;break;
+    case PFX_CB:
+      SIMPLIFIED(CodesFDCB)();break;
+    default:
+        if(CPU.TrapBadOps)  Trap_Bad_Ops(" FD ", I, CPU.PC.W-2);
+  }
+#undef XX
+}
+
+
+int SIMPLIFIED(ExecZ80)(register int RunCycles)
+{
+  register byte I;
+  register pair J;
+
+  for(CPU.ICount=RunCycles;;)
+  {
+    while(CPU.ICount>0)
+    {
+      /* Read opcode and count cycles */
+      I=OpZ80(CPU.PC.W++);
+      CPU.ICount-=Cycles[I];
+
+      /* Interpret opcode */
+      switch(I)
+      {
+#include "Codes.h"
+        case PFX_CB: SIMPLIFIED(CodesCB)();break;
+        case PFX_ED: 
+          if (OpZ80(CPU.PC.W) == 0xA3) // This is so common so we trap it here to avoid the slow function call overhead
+          {   //A3 is OUTI
+              CPU.PC.W++;
+              CPU.ICount-=16;
+              --CPU.BC.B.h;
+              I=RdZ80(CPU.HL.W++);
+              OutZ80(CPU.BC.W,I);
+              CPU.AF.B.l=(CPU.BC.B.h? 0:Z_FLAG)|(CPU.HL.B.l+I>255? (C_FLAG|H_FLAG):0);
+          }
+          else SIMPLIFIED(CodesED)();
+          break;
+        case PFX_FD: SIMPLIFIED(CodesFD)();break;
+        case PFX_DD: SIMPLIFIED(CodesDD)();break;
+      }
+    }
+    
+    /* Normally the R register would be incremented on every M1 CPU access... but for the optimized driver, we just increment it per scanline */
+    INCR(1);
+
+    /* Unless we have come here after EI, exit */
+    if(!(CPU.IFF&IFF_EI)) return(CPU.ICount);
+    else
+    {
+      /* Done with AfterEI state */
+      CPU.IFF=(CPU.IFF&~IFF_EI)|IFF_1;
+      /* Restore the ICount */
+      CPU.ICount+=CPU.IBackup-1;
+      /* Interrupt CPU if needed */
+      if((CPU.IRequest!=INT_NONE)&&(CPU.IRequest!=INT_QUIT)) IntZ80(&CPU,CPU.IRequest);
+    }
+  }
+}
@@ -109,7 +109,7 @@ void PIA_Write(word addr, byte data)
                 pia1.PDR = data;
 
                 /* Output to SN76489 */
-                sn76496W(data, &mySN);
+                SoundWriteSN(data);
 
                 pia1.prev_cycles = total_cycles;
 
@@ -713,6 +713,7 @@ void creativision_loadBAS(void)  // Taken from FunnyMU and adapted to reduce mem
       }
     }
     fclose(fp);
+    vdp_changed = 1;                              // We poked VRAM directly so make sure the screen is refreshed
   }
 }
 
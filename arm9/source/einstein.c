@@ -399,12 +399,13 @@ unsigned char cpu_readport_einstein(register unsigned short Port)
                   scan_keyboard();
                   return myKeyData;
                 }            
-                return ay38910DataR(&myAY);
+                return SoundReadAY();
             }
             else
             {
                 myAY.ayRegIndex = 0;
                 memset(myAY.ayRegs, 0x00, sizeof(myAY.ayRegs));    // Clear the AY registers... Port 0 or 1
+                memset(sound_ay_regs, 0x00, sizeof(sound_ay_regs)); // And what the program reads back
                 fdc_reset(FALSE);            // Reset is passed along to the FDC
             }
             break;
@@ -466,16 +467,15 @@ void cpu_writeport_einstein(register unsigned short Port,register unsigned char
             {
                 if (Port & 1)
                 {
-                    ay38910DataW(Value, &myAY);
+                    SoundWriteAY(Value);
                     if (myAY.ayRegIndex == 14) 
                     {
                         keyboard_w = Value;
                         scan_keyboard();
                     }
-                    else if (myAY.ayRegIndex == 8)
+                    else if ((myAY.ayRegIndex == 8) && myConfig.msxBeeper)
                     {
-                          extern u16 beeperFreq;
-                          if (!Value) beeperFreq++;
+                          SoundWriteBeeper(Value ? 1:0);    // Speccy ports hit PSG register 8 as a beeper
                     }                   
                 }
                 else 
@@ -487,6 +487,7 @@ void cpu_writeport_einstein(register unsigned short Port,register unsigned char
             {
                 myAY.ayRegIndex = 0;
                 memset(myAY.ayRegs, 0x00, sizeof(myAY.ayRegs));    // Clear the AY registers for port 0/1
+                memset(sound_ay_regs, 0x00, sizeof(sound_ay_regs)); // And what the program reads back
                 fdc_reset(FALSE);            // Reset is passed along to the FDC
             }
             break;
@@ -905,27 +906,5 @@ void einstein_reset(void)
 }
 
 
-// ------------------------------------------------------------------------
-// A few ZX Speccy ports utilize the beeper to "simulate" the sound... 
-// For the Einstein, this appears to be a rapid hit (writes) on PSG 
-// register 8 and we handle that in the IO write routine above. Not great
-// but it will render enough sounds to make the few speccy ports playable.
-// ------------------------------------------------------------------------
-extern u16 beeperFreq;
-extern u8 msx_beeper_process;
-extern u8 beeperWasOn;
-void einstein_HandleBeeper(void)
-{
-    if (++msx_beeper_process & 1)
-    {
-      if (beeperFreq > 0)
-      {
-          BeeperON(30 * beeperFreq); // Frequency in Hz
-          beeperFreq = 0;            // Gather new Beeper freq
-          beeperWasOn=1;
-      } else {if (beeperWasOn) {BeeperOFF(); beeperWasOn=0;}}
-    }
-}
-
 // End of file
 
@@ -0,0 +1,185 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <string.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------------------
+// The frame sink - getting the finished frame in XBuf onto the display at vertical
+// blank. SelectSink9918() in tms9918a.c sets up the target for the FRAME_BLEND_xxx
+// option, the renderers mark the rows they change in vdp_dirty_rows and this sends
+// just those rows out (or blends them). It has no other ties to the emulator so that
+// the host tests can run it against their own memory in place of VDP_SINK_BG3/BG2.
+// ---------------------------------------------------------------------------------------
+
+/*********************************************************************************
+ * OR together 'words' 32-bit words of the two frames into the display. On the
+ * DS this is an LDM/STM kernel moving four words from each frame per step so
+ * the slow main RAM and VRAM see bursts rather than single word accesses - it
+ * needs 'words' to be a multiple of 4, which whole rows always are. The host
+ * builds OR 128 bits at a time with NEON or SSE2 and finish any odd words in
+ * plain C, which is also kept for any other build.
+ ********************************************************************************/
+ITCM_CODE void colecoBlendWords(u32 *p1, u32 *p2, u32 *destP, u32 words)
+{
+#if defined(__ARM_NEON)
+    u32 i = 0;
+    for (; i+4 <= words; i += 4)
+    {
+        vst1q_u32(destP + i, vorrq_u32(vld1q_u32(p1 + i), vld1q_u32(p2 + i)));
+    }
+    for (; i<words; i++)
+    {
+        destP[i] = (p1[i] | p2[i]);
+    }
+#elif defined(__arm__)
+    words >>= 2;
+    asm volatile (
+        "1:                              \n"
+        "   ldmia   %[a]!, {r4-r7}       \n"
+        "   ldmia   %[b]!, {r8-r10,r12}  \n"
+        "   orr     r4, r4, r8           \n"
+        "   orr     r5, r5, r9           \n"
+        "   orr     r6, r6, r10          \n"
+        "   orr     r7, r7, r12          \n"
+        "   stmia   %[d]!, {r4-r7}       \n"
+        "   subs    %[n], %[n], #1       \n"
+        "   bne     1b                   \n"
+        : [a] "+r" (p1), [b] "+r" (p2), [d] "+r" (destP), [n] "+r" (words)
+        :
+        : "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r12", "cc", "memory"
+    );
+#elif defined(__SSE2__)
+    u32 i = 0;
+    for (; i+4 <= words; i += 4)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(p1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(p2 + i));
+        _mm_storeu_si128((__m128i*)(destP + i), _mm_or_si128(a, b));
+    }
+    for (; i<words; i++)
+    {
+        destP[i] = (p1[i] | p2[i]);
+    }
+#else
+    for (u32 i=0; i<words; i++)
+    {
+        destP[i] = (p1[i] | p2[i]);       // Simple OR blending of 2 frames...
+    }
+#endif
+}
+
+/*********************************************************************************
+ * Update the screen for the current cycle. On the DSi this will generally
+ * be called right after swiWaitForVBlank() in TMS9918a.c which will help
+ * reduce visual tearing and other artifacts. It's not strictly necessary
+ * and that does slow down the loop a bit... but DSi can handle it.
+ ********************************************************************************/
+ITCM_CODE void colecoUpdateScreen(void)
+{
+    // ------------------------------------------------------------
+    // If no VRAM or VDP register has been written for the last
+    // few frames, the picture is identical to what's already on
+    // the screen (static menus, paused games, etc). We can skip
+    // both the DMA transfer and the CPU-heavy frame blending.
+    // The VDP ports only set vdp_changed - it becomes a fresh
+    // countdown here once per frame.
+    // ------------------------------------------------------------
+    if (vdp_changed) {vdp_dirty = VDP_DIRTY_FRAMES; vdp_changed = 0;}
+    if (!vdp_dirty) return;
+    vdp_dirty--;
+
+    // ------------------------------------------------------------
+    // Without CPU blending, the rows that changed this frame are
+    // sent to the display with one asynchronous DMA covering the
+    // first to the last changed row. We're at vertical blank so
+    // nothing is torn and the CPU gets straight back to work. For
+    // the DS LAYERS blend we then swap which of the two bitmap
+    // layers (and which XBuf) the next frame goes to.
+    // ------------------------------------------------------------
+    if (vdp_sink != FRAME_BLEND_CPU)
+    {
+        u8 first = 0, last = 191;
+        while ((first < 192) && !(vdp_dirty_rows[first>>5] & (1 << (first&31)))) first++;
+        if (first < 192)
+        {
+            while (!(vdp_dirty_rows[last>>5] & (1 << (last&31)))) last--;
+            u32 offset = first << 8;
+            u32 len = (last + 1 - first) << 8;
+            DC_FlushRange(XBuf + offset, len);     // The DMA reads main RAM - not what is still sitting in the cache
+            dmaCopyWordsAsynch(2, XBuf + offset, (u8*)pVidFlipBuf + offset, len);
+            memset(vdp_dirty_rows, 0x00, sizeof(vdp_dirty_rows));
+        }
+
+        if (vdp_sink == FRAME_BLEND_LAYERS)
+        {
+            if (XBuf == XBuf_A)
+            {
+                XBuf = XBuf_B;
+                pVidFlipBuf = VDP_SINK_BG2;
+            }
+            else
+            {
+                XBuf = XBuf_A;
+                pVidFlipBuf = VDP_SINK_BG3;
+            }
+        }
+        return;
+    }
+
+    // ------------------------------------------------------------
+    // If we are in 'blendMode' we will OR the last two frames.
+    // This helps on some games where things are just 1 pixel
+    // wide and the non XL/LL DSi will just not hold onto the
+    // image long enough to render it properly for the eye to
+    // pick up. This takes CPU speed, however, and will not be
+    // supported for older DS-LITE/PHAT units with slower CPU.
+    // ------------------------------------------------------------
+    if (XBuf == XBuf_A)
+    {
+        XBuf = XBuf_B;
+    }
+    else
+    {
+        XBuf = XBuf_A;
+
+        // ------------------------------------------------------------------
+        // Because we are OR-ing two frames together, we only need to blend
+        // every other frame... and only the rows that changed in either of
+        // the two frames since the last blend. Runs of changed rows are
+        // blended in one go to keep the kernel streaming.
+        // ------------------------------------------------------------------
+        u8 y = 0;
+        while (y < 192)
+        {
+            if (!(vdp_dirty_rows[y>>5] & (1 << (y&31)))) {y++; continue;}
+
+            u8 first = y;
+            while ((y < 192) && (vdp_dirty_rows[y>>5] & (1 << (y&31)))) y++;
+
+            u32 offset = first << 6;
+            colecoBlendWords((u32*)XBuf_A + offset, (u32*)XBuf_B + offset, (u32*)pVidFlipBuf + offset, (y - first) << 6);
+        }
+        memset(vdp_dirty_rows, 0x00, sizeof(vdp_dirty_rows));
+    }
+}
+
+// End of file
@@ -26,6 +26,7 @@
 #include "MSX_CBIOS.h"
 #include "fdc.h"
 #include "printf.h"
+#include "pagedrom.h"
 
 // ---------------------------------------
 // Some MSX Mapper / Slot Handling stuff
@@ -37,9 +38,6 @@ u8 bRAMInSegment[4]     __attribute__((section(".dtcm"))) = {0,0,0,0};
 
 u8 *MSXCartPtr[8]       __attribute__((section(".dtcm"))) = {0,0,0,0,0,0,0,0};
 
-u16 beeperFreq          __attribute__((section(".dtcm"))) = 0;
-u8 msx_beeper_process   __attribute__((section(".dtcm"))) = 0;
-u8 beeperWasOn          __attribute__((section(".dtcm"))) = 0;
 u8 msx_sram_enabled     __attribute__((section(".dtcm"))) = 0;
 
 u16 msx_block_size      __attribute__((section(".dtcm"))) = 0x2000; // Either 8K or 16K based on Mapper Type
@@ -112,7 +110,7 @@ unsigned char cpu_readport_msx(register unsigned short Port)
           // When reading PORTB of the PSG, just echo back the last value written (the MSX BIOS needs this as it will preserve the KANA LED bit)
           myAY.ayPortBIn = myAY.ayPortBOut;
       }      
-      return ay38910DataR(&myAY);
+      return SoundReadAY();
   }
   else if (Port == 0xA8) return Port_PPI_A;
   else if (Port == 0xA9)
@@ -1324,7 +1322,7 @@ void cpu_writeport_msx(register unsigned short Port,register unsigned char Value
     if      (Port == 0x98) WrData9918(Value);
     else if (Port == 0x99) {if (WrCtrl9918(Value)) { CPU.IRequest=INT_RST38; }}
     else if (Port == 0xA0) {ay38910IndexW(Value&0xF, &myAY);}   // PSG Area
-    else if (Port == 0xA1) {ay38910DataW(Value, &myAY);}
+    else if (Port == 0xA1) {SoundWriteAY(Value);}
     else if (Port == 0xA8) // Slot system for MSX
     {
         if (Port_PPI_A != Value)
@@ -1356,25 +1354,19 @@ void cpu_writeport_msx(register unsigned short Port,register unsigned char Value
     }
     else if (Port == 0xAA)  // PPI - Register C
     {
-        if (Value & 0x80)  // Beeper ON
-        {
-            if ((Port_PPI_C & 0x80) == 0) beeperFreq++;
-        }
+        if (myConfig.msxBeeper) SoundWriteBeeper(Value >> 7);   // Key click / beeper is bit 7
         Port_PPI_C = Value;
         msx_caps_lock = ((Port_PPI_C & 0x40) ? 0:1);
     }
     else if (Port == 0xAB)  // PPI - Register C Fast Modify
     {
-        if ((Value & 0x0E) == 0x0E) // Are we hitting the Beeper ON/OFF bit?
-        {
-            if ((Value & 1) && ((Port_PPI_C & 0x80) == 0)) beeperFreq++;   // Beeper ON
-        }
-        
         // Set or clear the proper bit in PORTC
         u8 bit =  (Value & 0x0E) >> 1;
         if (Value & 1) Port_PPI_C |= (1 << bit);
         else Port_PPI_C &= ~(1 << bit);
 
+        if (myConfig.msxBeeper && (bit == 7)) SoundWriteBeeper(Value & 1);  // Key click / beeper
+
         msx_caps_lock = ((Port_PPI_C & 0x40) ? 0:1);
     }
     else if (Port >= 0xD0 && Port <= 0xD7)  // Floppy Drive Controller
@@ -1777,11 +1769,18 @@ void MSX_InitialMemoryLayout(u32 romSize)
         MSXCartPtr[7] = (u8*)ROM_Memory+0xE000;        // Segment 7
         
     }
-    else if ((romSize >= (16 * 1024)) && (romSize <= (MAX_CART_SIZE * 1024)))   // We'll take anything between these two...
+    else if ((romSize >= (16 * 1024)) && ((romSize <= (MAX_CART_SIZE * 1024)) || paged_rom))   // We'll take anything between these two... or bigger if paged
     {
         if (myConfig.msxMapper == GUESS)
         {
-            mapperType = MSX_GuessROMType(romSize);
+            // ---------------------------------------------------------------------------
+            // A paged ROM is guessed from the first MAX_CART_SIZE of the file which is
+            // read back into ROM_Memory[] after the CRC pass for any MSX cart that big
+            // (see ReloadRomStart()). Once paging is setup ROM_Memory[]
+            // holds whatever banks were last used so on a reset we keep the first guess.
+            // ---------------------------------------------------------------------------
+            if (!paged_rom) mapperType = MSX_GuessROMType(romSize);
+            else if (!paged_frame_size) mapperType = MSX_GuessROMType(MAX_CART_SIZE * 1024);
         }
         else
         {
@@ -1877,66 +1876,9 @@ void MSX_InitialMemoryLayout(u32 romSize)
     }
     
     msx_block_size = ((mapperType == ASC16 || mapperType == ZEN16 || mapperType == XBLAM) ? 0x4000:0x2000);
+    PagedROMSetup(msx_block_size);      // Only does anything for a demand-paged ROM
 }
 
-/*********************************************************************************
- * A few ZX Speccy ports utilize the MSX beeper to "simulate" the sound...
- ********************************************************************************/
-
-// ------------------------------------------------------------------------------------
-// If the MSX Beeper is being used (rare but a few of the ZX Spectrum ports use it), 
-// then we need to service it here. We basically track the frequency at which the
-// game has hit the beeper and approximate that by using AY Channel A to produce the 
-// tone.  This is crude and doesn't sound quite right... but good enough.
-// ------------------------------------------------------------------------------------
-void BeeperOFF(void)
-{
-    sn76496W(0x80 | 0x00,&mySN);    // Write new Frequency for Channel A
-    sn76496W(0x00 | 0x00,&mySN);    // Write new Frequency for Channel A
-    sn76496W(0x90 | 0x0F,&mySN);    // Write new Volume for Channel A
-
-    sn76496W(0xA0 | 0x00,&mySN);    // Write new Frequency for Channel B
-    sn76496W(0x00 | 0x00,&mySN);    // Write new Frequency for Channel B
-    sn76496W(0xB0 | 0x0F,&mySN);    // Write new Volume for Channel B
-
-    sn76496W(0xC0 | 0x00,&mySN);    // Write new Frequency for Channel C
-    sn76496W(0x00 | 0x00,&mySN);    // Write new Frequency for Channel C
-    sn76496W(0xD0 | 0x0F,&mySN);    // Write new Volume for Channel C
-
-    sn76496W(0xFF,  &mySN);         // Disable Noise Channel
-}
-
-void BeeperON(u16 beeper_freq)
-{
-    if (beeper_freq > 0)
-    {
-        if (beeper_freq > 0x3E0) beeper_freq = 0x3E0;
-        beeper_freq = 0x3FF - beeper_freq;
-        
-        sn76496W(0x80 | (beeper_freq & 0xF), &mySN);
-        sn76496W(0x00 | ((beeper_freq >> 4) & 0x1F), &mySN);
-        sn76496W(0x97, &mySN); // Turn on sound at fixed "mid" volume 
-    }
-    else 
-    {
-        BeeperOFF();
-    }
-}
-
-void MSX_HandleBeeper(void)
-{
-    if (++msx_beeper_process & 1)
-    {
-      if (beeperFreq > 0)
-      {
-          BeeperON(30 * beeperFreq); // Frequency in Hz
-          beeperFreq = 0;            // Gather new Beeper freq
-          beeperWasOn=1;
-      } else {if (beeperWasOn) {BeeperOFF(); beeperWasOn=0;}}
-    }
-}
-
-
 // ---------------------------------------------------------
 // Restore the BIOS and point to it...
 // ---------------------------------------------------------
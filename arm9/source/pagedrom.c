@@ -0,0 +1,212 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "colecogeneric.h"
+#include "pagedrom.h"
+
+#define PAGED_NO_DATA       0xFFFFFFFF  // Bank lies past the end of the file - reads back as 0xFF
+
+u8   paged_rom          __attribute__((section(".dtcm"))) = 0;
+u16  paged_frame_size   __attribute__((section(".dtcm"))) = 0;
+u32  paged_rom_hits     = 0;
+u32  paged_rom_misses   = 0;
+
+FILE *paged_fp          = 0;            // Kept open so a miss is just a seek and read
+u32   paged_rom_size    = 0;
+u16   paged_frames      = 0;            // How many frames fit in the pool
+u32   paged_clock       = 0;
+
+// ---------------------------------------------------------------------------------------
+// The index is built when the mapper is known: where each bank lives in the file and
+// which frame (if any) holds it right now. The frames remember their bank and when they
+// were last selected so we can find the least recently used one.
+// ---------------------------------------------------------------------------------------
+u32  paged_bank_offset[PAGED_MAX_BANKS];
+u16  paged_bank_frame[PAGED_MAX_BANKS];
+u16  paged_frame_bank[PAGED_MAX_FRAMES];
+u32  paged_frame_used[PAGED_MAX_FRAMES];
+
+void PagedROMClose(void)
+{
+    if (paged_fp) fclose(paged_fp);
+    paged_fp = 0;
+    paged_rom = 0;
+    paged_frame_size = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called from loadrom() for a ROM too big for ROM_Memory[]. Only MSX cart ROMs are paged
+// - everything else either fits or (like the 31-in-1 carts) has its own bank handling.
+// ---------------------------------------------------------------------------------------
+u8 PagedROMInit(const char *filename, u32 romSize)
+{
+    PagedROMClose();
+
+    if (msx_mode != 1) return 0;
+    if (romSize > PAGED_ROM_MAX_SIZE) return 0;
+
+    paged_fp = fopen(filename, "rb");
+    if (!paged_fp) return 0;
+
+    paged_rom_size = romSize;
+    paged_rom = 1;
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Read a bank from the file into a frame and update the index both ways.
+// ---------------------------------------------------------------------------------------
+static void PagedROMFill(u16 frame, u16 bank)
+{
+    u8 *dest = ROM_Memory + ((u32)frame * paged_frame_size);
+    u32 offset = paged_bank_offset[bank];
+    u32 len = 0;
+
+    if (offset != PAGED_NO_DATA)
+    {
+        u32 want = paged_rom_size - offset;
+        if (want > paged_frame_size) want = paged_frame_size;
+        fseek(paged_fp, offset, SEEK_SET);
+        len = fread(dest, 1, want, paged_fp);
+    }
+    if (len < paged_frame_size) memset(dest + len, 0xFF, paged_frame_size - len);
+
+    if (paged_frame_bank[frame] != PAGED_NO_FRAME) paged_bank_frame[paged_frame_bank[frame]] = PAGED_NO_FRAME;
+    paged_frame_bank[frame] = bank;
+    paged_bank_frame[bank] = frame;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once MSX_InitialMemoryLayout() knows the mapper. Every mapper starts out with
+// the first 32K mapped in at ROM_Memory+0x0000 to 0x7FFF so those banks are read into
+// the first frames - which puts them right where the initial layout expects them.
+// ---------------------------------------------------------------------------------------
+void PagedROMSetup(u16 frameSize)
+{
+    if (!paged_rom) return;
+
+    paged_frame_size = frameSize;
+    paged_frames = (COMPRESS_BUFFER - ROM_Memory) / frameSize;   // The back end of ROM_Memory[] is borrowed for compression and screenshots
+    if (paged_frames > PAGED_MAX_FRAMES) paged_frames = PAGED_MAX_FRAMES;
+
+    for (u16 bank=0; bank<PAGED_MAX_BANKS; bank++)
+    {
+        u32 offset = (u32)bank * frameSize;
+        paged_bank_offset[bank] = ((offset < paged_rom_size) ? offset : PAGED_NO_DATA);
+        paged_bank_frame[bank] = PAGED_NO_FRAME;
+    }
+    for (u16 frame=0; frame<PAGED_MAX_FRAMES; frame++)
+    {
+        paged_frame_bank[frame] = PAGED_NO_FRAME;
+        paged_frame_used[frame] = 0;
+    }
+    paged_clock = 0;
+    paged_rom_hits = 0;
+    paged_rom_misses = 0;
+
+    for (u16 frame=0; frame < (0x8000 / frameSize); frame++)
+    {
+        PagedROMFill(frame, frame);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// A frame can't be thrown out while any slot page still points into it.
+// ---------------------------------------------------------------------------------------
+static u8 PagedFrameMapped(u16 frame)
+{
+    u8 *start = ROM_Memory + ((u32)frame * paged_frame_size);
+    u8 *end = start + paged_frame_size;
+
+    for (u8 i=0; i<8; i++)
+    {
+        if ((MSXCartPtr[i] >= start) && (MSXCartPtr[i] < end)) return 1;
+        if ((MemoryMap[i]  >= start) && (MemoryMap[i]  < end)) return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// The mapper wants this bank - return the frame holding it, reading it in if needed.
+// ---------------------------------------------------------------------------------------
+ITCM_CODE u8 *PagedROMBank(u32 bank)
+{
+    bank &= (PAGED_MAX_BANKS-1);
+    u16 frame = paged_bank_frame[bank];
+
+    if (frame == PAGED_NO_FRAME)
+    {
+        u16 victim = PAGED_NO_FRAME;
+        for (u16 f=0; f<paged_frames; f++)
+        {
+            if (PagedFrameMapped(f)) continue;
+            if ((victim == PAGED_NO_FRAME) || (paged_frame_used[f] < paged_frame_used[victim])) victim = f;
+        }
+        if (victim == PAGED_NO_FRAME) victim = 0;   // Can't happen - the pool is far bigger than the 8 slot pages
+        PagedROMFill(victim, bank);
+        frame = victim;
+        paged_rom_misses++;
+    }
+    else paged_rom_hits++;
+
+    paged_frame_used[frame] = ++paged_clock;
+    return ROM_Memory + ((u32)frame * paged_frame_size);
+}
+
+// ---------------------------------------------------------------------------------------
+// The save state holds the slot pointers into ROM_Memory[] so we also keep which bank
+// each frame held (in the spare bytes) and put the same banks back in the same frames.
+// Returns 0 if the tags are missing or don't fit this ROM - the slot pointers restored
+// from the save would then point at the wrong banks so the load has to fail.
+// ---------------------------------------------------------------------------------------
+void PagedROMSaveTags(u8 *dest)
+{
+    u16 header[3] = {PAGED_STATE_MAGIC, paged_frame_size, paged_frames};
+    memcpy(dest, header, sizeof(header));
+    memcpy(dest + sizeof(header), paged_frame_bank, paged_frames * sizeof(u16));
+}
+
+u8 PagedROMLoadTags(const u8 *src)
+{
+    u16 header[3];
+    u16 tags[PAGED_MAX_FRAMES];
+
+    memcpy(header, src, sizeof(header));
+    if ((header[0] != PAGED_STATE_MAGIC) || (header[1] != paged_frame_size) || (header[2] != paged_frames)) return 0;
+    memcpy(tags, src + sizeof(header), paged_frames * sizeof(u16));
+
+    // Check them all before any frame is touched
+    for (u16 frame=0; frame<paged_frames; frame++)
+    {
+        if ((tags[frame] != PAGED_NO_FRAME) && (tags[frame] >= PAGED_MAX_BANKS)) return 0;
+    }
+
+    for (u16 frame=0; frame<paged_frames; frame++)
+    {
+        if (tags[frame] == PAGED_NO_FRAME) paged_frame_bank[frame] = PAGED_NO_FRAME;
+        else if (tags[frame] != paged_frame_bank[frame]) PagedROMFill(frame, tags[frame]);
+    }
+
+    // And rebuild the index from the frames so no bank is left pointing at a frame it was pushed out of
+    for (u16 bank=0; bank<PAGED_MAX_BANKS; bank++) paged_bank_frame[bank] = PAGED_NO_FRAME;
+    for (u16 frame=0; frame<paged_frames; frame++)
+    {
+        if (paged_frame_bank[frame] != PAGED_NO_FRAME) paged_bank_frame[paged_frame_bank[frame]] = frame;
+        paged_frame_used[frame] = 0;
+    }
+    return 1;
+}
@@ -0,0 +1,40 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _PAGEDROM_H_
+#define _PAGEDROM_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// Demand-paged ROM for MSX megaROMs bigger than ROM_Memory[] (MAX_CART_SIZE). The ROM
+// buffer becomes a pool of bank sized frames (8K or 16K - whatever the mapper switches)
+// and a bank is only read from the file the first time a mapper selects it. When the
+// pool is full the least recently selected bank that isn't mapped in gets thrown out.
+// ---------------------------------------------------------------------------------------
+#define PAGED_ROM_MAX_SIZE      (4096*1024) // 256 banks of 16K is as far as any MSX mapper reaches
+#define PAGED_MAX_FRAMES        128         // Keeps the frame tags small enough for the save state spare bytes
+#define PAGED_MAX_BANKS         256
+#define PAGED_NO_FRAME          0xFFFF
+#define PAGED_STATE_MAGIC       0x5047      // "PG" - marks the frame tags in the save state spare bytes
+
+extern u8   paged_rom;                      // Non-zero when the cart ROM is demand-paged
+extern u16  paged_frame_size;               // 0x2000 or 0x4000 once the mapper is known
+extern u32  paged_rom_hits;
+extern u32  paged_rom_misses;
+
+extern u8   PagedROMInit(const char *filename, u32 romSize);
+extern void PagedROMSetup(u16 frameSize);
+extern void PagedROMClose(void);
+extern u8  *PagedROMBank(u32 bank);
+extern void PagedROMSaveTags(u8 *dest);
+extern u8   PagedROMLoadTags(const u8 *src);
+
+#endif // _PAGEDROM_H_
@@ -59,6 +59,15 @@ u8 pv1000_palette[8*3] = {
 
 uint32_t pv1000_pattern_table[3][16] __attribute__((section(".dtcm")));
 
+// ---------------------------------------------------------------------------------------
+// Cell cache - most PV-1000 games only change a handful of cells each frame so we
+// remember what was drawn in each cell (and the PCG glyphs as they were drawn) and
+// only redraw the cells that changed and copy the rows they live in to the screen.
+// ---------------------------------------------------------------------------------------
+uint8_t  pv1000_last_code[24][32];                                  // Code last drawn in each cell
+uint8_t  pv1000_last_pcg[32*32];                                    // PCG RAM as it was when last drawn
+uint8_t  pv1000_redraw_all      __attribute__((section(".dtcm"))) = 1; // Set when the whole screen must be redrawn
+
 /*********************************************************************************
  * Set Spectrum color palette... 8 colors in 2 intensities
  ********************************************************************************/
@@ -87,6 +96,7 @@ void pv1000_reset(void)
     memset(bg, 0, sizeof(bg));
 
     pv1000_scanline = 0;
+    pv1000_redraw_all = 1;
 
     pv1000_vram = RAM_Memory+0xB800;
     pv1000_pcg = RAM_Memory+0xBC00;
@@ -252,37 +262,37 @@ void cpu_writeport_pv1000(register unsigned short Port,register unsigned char da
     {
         case 0xF8:
             pv1000_freqA = freq_table[0x3f - (data & 0x3f)];
-            sn76496W(0x80 | (pv1000_freqA & 0x0F),       &mySN);    // Write new Frequency for Channel A
-            sn76496W(0x00 | ((pv1000_freqA >> 4) & 0x3F),&mySN);    // Write new Frequency for Channel A
-            sn76496W(0x90 | (pv1000_freqA ? 0x09:0x0F),  &mySN);    // Write new Volume for Channel A
+            SoundWriteSN(0x80 | (pv1000_freqA & 0x0F));             // Write new Frequency for Channel A
+            SoundWriteSN(0x00 | ((pv1000_freqA >> 4) & 0x3F));      // Write new Frequency for Channel A
+            SoundWriteSN(0x90 | (pv1000_freqA ? 0x09:0x0F));        // Write new Volume for Channel A
             break;
 
         case 0xF9:
             pv1000_freqB = freq_table[0x3f - (data & 0x3f)];
-            sn76496W(0xA0 | (pv1000_freqB & 0x0F),       &mySN);    // Write new Frequency for Channel B
-            sn76496W(0x00 | ((pv1000_freqB >> 4) & 0x3F),&mySN);    // Write new Frequency for Channel B
-            sn76496W(0xB0 | (pv1000_freqB ? 0x07:0x0F),  &mySN);    // Write new Volume for Channel B (louder than A)
+            SoundWriteSN(0xA0 | (pv1000_freqB & 0x0F));             // Write new Frequency for Channel B
+            SoundWriteSN(0x00 | ((pv1000_freqB >> 4) & 0x3F));      // Write new Frequency for Channel B
+            SoundWriteSN(0xB0 | (pv1000_freqB ? 0x07:0x0F));        // Write new Volume for Channel B (louder than A)
             break;
 
         case 0xFA:
             pv1000_freqC = freq_table[0x3f - (data & 0x3f)];
-            sn76496W(0xC0 | (pv1000_freqC & 0x0F),       &mySN);    // Write new Frequency for Channel C
-            sn76496W(0x00 | ((pv1000_freqC >> 4) & 0x3F),&mySN);    // Write new Frequency for Channel C
-            sn76496W(0xD0 | (pv1000_freqC ? 0x05:0x0F),  &mySN);    // Write new Volume for Channel C (louder than A or B)
+            SoundWriteSN(0xC0 | (pv1000_freqC & 0x0F));             // Write new Frequency for Channel C
+            SoundWriteSN(0x00 | ((pv1000_freqC >> 4) & 0x3F));      // Write new Frequency for Channel C
+            SoundWriteSN(0xD0 | (pv1000_freqC ? 0x05:0x0F));        // Write new Volume for Channel C (louder than A or B)
             break;
 
         case 0xFB:
             if (data & 2) // Sound Enable
             {
-                sn76496W(0x90 | (pv1000_freqA ? 0x09:0x0F),  &mySN); // Write new Volume for Channel A
-                sn76496W(0xB0 | (pv1000_freqB ? 0x07:0x0F),  &mySN); // Write new Volume for Channel B
-                sn76496W(0xD0 | (pv1000_freqC ? 0x05:0x0F),  &mySN); // Write new Volume for Channel C
+                SoundWriteSN(0x90 | (pv1000_freqA ? 0x09:0x0F));     // Write new Volume for Channel A
+                SoundWriteSN(0xB0 | (pv1000_freqB ? 0x07:0x0F));     // Write new Volume for Channel B
+                SoundWriteSN(0xD0 | (pv1000_freqC ? 0x05:0x0F));     // Write new Volume for Channel C
             }
             else // Sound Disable (Mute)
             {
-                sn76496W(0x90 | 0x0F,  &mySN);    // Write new Volume for Channel A (sound off)
-                sn76496W(0xB0 | 0x0F,  &mySN);    // Write new Volume for Channel B (sound off)
-                sn76496W(0xD0 | 0x0F,  &mySN);    // Write new Volume for Channel C (sound off)
+                SoundWriteSN(0x90 | 0x0F);        // Write new Volume for Channel A (sound off)
+                SoundWriteSN(0xB0 | 0x0F);        // Write new Volume for Channel B (sound off)
+                SoundWriteSN(0xD0 | 0x0F);        // Write new Volume for Channel C (sound off)
             }
 
             // We don't support XOR/Ring (bit 0) - Fighting Bug makes use of this so the sound there won't be perfect
@@ -374,22 +384,64 @@ ITCM_CODE void draw_pcg(int x8, int y8, uint16_t top)
 
 ITCM_CODE void pv1000_drawscreen(void)
 {
+    static uint8_t *last_vram = 0, *last_pcg = 0, *last_pattern = 0;
+    static uint8_t  last_force = 0;
+
     // --------------------------------------------------------------
     // If the display is disabled, we simply output the border color
     // --------------------------------------------------------------
     if (pv1000_vid_disable)
     {
         memset((uint8_t*) (0x06000000), pv1000_bd_color, 192*256);
+        pv1000_redraw_all = 1;  // The border has replaced everything on screen
         return;
     }
 
+    // -------------------------------------------------------------------
+    // Moving any of the tables around changes what every cell means...
+    // -------------------------------------------------------------------
+    if ((pv1000_vram != last_vram) || (pv1000_pcg != last_pcg) || (pv1000_pattern != last_pattern) || (pv1000_force_pattern != last_force))
+    {
+        last_vram    = pv1000_vram;
+        last_pcg     = pv1000_pcg;
+        last_pattern = pv1000_pattern;
+        last_force   = pv1000_force_pattern;
+        pv1000_redraw_all = 1;
+    }
+
+    // -------------------------------------------------------------------
+    // Find which of the 32 PCG (RAM) glyphs have changed since we last
+    // drew them. Only bytes 8-31 of each glyph hold the 3 color planes.
+    // -------------------------------------------------------------------
+    uint32_t pcg_dirty = 0;
+    if (pv1000_redraw_all)
+    {
+        memcpy(pv1000_last_pcg, pv1000_pcg, sizeof(pv1000_last_pcg));
+    }
+    else
+    {
+        for (int c = 0; c < 32; c++)
+        {
+            if (memcmp(pv1000_pcg + (c<<5) + 8, pv1000_last_pcg + (c<<5) + 8, 24))
+            {
+                memcpy(pv1000_last_pcg + (c<<5) + 8, pv1000_pcg + (c<<5) + 8, 24);
+                pcg_dirty |= (1 << c);
+            }
+        }
+    }
+
+    // A pattern table in RAM could have been rewritten anywhere - so we don't trust the cache there
+    uint8_t pattern_dirty = (pv1000_pattern >= (RAM_Memory + 0x8000));
+
     // -------------------------------------------------------------------
     // Otherwise we render... the first two and last two columns are
     // not displayed on a PV-1000 so we only get 244 pixels (out of 256).
     // -------------------------------------------------------------------
+    uint8_t *dest = (uint8_t*) (0x06000000);
     for (int y = 0; y < 24; y++)
     {
         int y8 = y << 3, y32 = y << 5;
+        uint8_t row_dirty = 0;
 
         for(int x = 2; x < 30; x++)
         {
@@ -398,22 +450,36 @@ ITCM_CODE void pv1000_drawscreen(void)
 
             if(code < 0xe0 || pv1000_force_pattern)
             {
-                draw_pattern(x8, y8, code << 5);
+                if (pv1000_redraw_all || pattern_dirty || (code != pv1000_last_code[y][x]))
+                {
+                    draw_pattern(x8, y8, code << 5);
+                    pv1000_last_code[y][x] = code;
+                    row_dirty = 1;
+                }
             }
             else
             {
-                draw_pcg(x8, y8, (code & 0x1f) << 5);
+                if (pv1000_redraw_all || (pcg_dirty & (1 << (code & 0x1f))) || (code != pv1000_last_code[y][x]))
+                {
+                    draw_pcg(x8, y8, (code & 0x1f) << 5);
+                    pv1000_last_code[y][x] = code;
+                    row_dirty = 1;
+                }
             }
         }
+
+        // -----------------------------------------------------------------------------
+        // Now copy this row of cells to the DS LCD screen memory... I would have
+        // preferred to use an Async copy here but due to the rendering above, some
+        // of the data will be in ARM fast data cache and an async copy can get glitchy.
+        // -----------------------------------------------------------------------------
+        if (row_dirty)
+        {
+            memcpy(dest + (y8 * 256), bg[y8], 8*256);
+        }
     }
 
-    // -----------------------------------------------------------------------------
-    // Now copy the pv1000_pattern to the DS LCD screen memory... I would have
-    // preferred to use an Async copy here but due to the rendering above, some
-    // of the data will be in ARM fast data cache and an async copy can get glitchy.
-    // -----------------------------------------------------------------------------
-    uint8_t *dest = (uint8_t*) (0x06000000);
-    memcpy(dest, bg, 192*256);
+    pv1000_redraw_all = 0;
 }
 
 // -------------------------------------------------------------------------------------------
@@ -432,10 +498,7 @@ ITCM_CODE u32 pv1000_run(void)
     if (pv1000_vid_disable) cycles_to_process = 230 + CPU.CycleDeficit;
     CPU.CycleDeficit = ExecZ80(cycles_to_process);
 
-    if (myConfig.soundDriver)
-    {
-        processDirectAudioSN();
-    }
+    sound_emu_pos += sound_line_step;    // Sound chip writes are timestamped against this
 
     // -------------------------------------------------------------------------------------
     // There are either 1 or 16 VSYNC interrupts depending on the value written to the
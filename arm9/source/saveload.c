@@ -28,6 +28,7 @@
 #include "fdc.h"
 #include "lzav.h"
 #include "printf.h"
+#include "pagedrom.h"
 
 #define COLECODS_SAVE_VER   0x0022  // Change this if the basic format of the .SAV file changes. Invalidates older .sav files.
 
@@ -197,7 +198,8 @@ void colecoSaveState(void)
     pSvg = SprTab-pVDPVidMem;
     if (retVal) retVal = fwrite(&pSvg, sizeof(pSvg),1, handle);
 
-    // Write PSG SN and AY sound chips...
+    // Write PSG SN and AY sound chips... with any queued 'Wave Direct' writes applied first
+    SoundQueueFlush();
     if (retVal) retVal = fwrite(&mySN, sizeof(mySN),1, handle);
     if (retVal) retVal = fwrite(&myAY, sizeof(myAY),1, handle);
 
@@ -259,8 +261,10 @@ void colecoSaveState(void)
     if (retVal) retVal = fwrite(&simplifed_low_addr, sizeof(simplifed_low_addr),1, handle);
     if (retVal) retVal = fwrite(under_ram, sizeof(under_ram),1, handle);
 
-    // Some spare memory we can eat into...
+    // Some spare memory we can eat into... a demand-paged ROM keeps its frame tags here
+    if (paged_rom) PagedROMSaveTags(spare);
     if (retVal) retVal = fwrite(spare, 510, 1, handle);
+    if (paged_rom) memset(spare, 0x00, sizeof(spare));
 
     if (einstein_mode) // Big enough that we will not write this if we are not Einstein
     {
@@ -479,12 +483,13 @@ void colecoLoadState(void)
             if (retVal) retVal = fread(&OH, sizeof(OH),1, handle);
             if (retVal) retVal = fread(&IH, sizeof(IH),1, handle);
             if (retVal) retVal = fread(&ScrMode, sizeof(ScrMode),1, handle);
-            extern void (*RefreshLine)(u8 uY);  RefreshLine = SCR[ScrMode].Refresh;
+            InvalidateTextCache();
             if (retVal) retVal = fread(&VDPDlatch, sizeof(VDPDlatch),1, handle);
             if (retVal) retVal = fread(&VAddr, sizeof(VAddr),1, handle);
             if (retVal) retVal = fread(&CurLine, sizeof(CurLine),1, handle);
             if (retVal) retVal = fread(&ColTabM, sizeof(ColTabM),1, handle);
             if (retVal) retVal = fread(&ChrGenM, sizeof(ChrGenM),1, handle);
+            SelectRefresh9918();
 
             // Restore VDP RAM memory which was saved in a compressed format
             if (retVal) retVal = fread(&comp_len,          sizeof(comp_len), 1, handle);
@@ -501,6 +506,9 @@ void colecoLoadState(void)
             SprGen = pSvg + pVDPVidMem;
             if (retVal) retVal = fread(&pSvg, sizeof(pSvg),1, handle);
             SprTab = pSvg + pVDPVidMem;
+            ResetLog9918();     // Any deferred VDP writes belong to the state we just replaced
+            vdp_dirty = VDP_DIRTY_FRAMES;
+            vdp_changed = 1;
 
             // Read PSG SN and AY sound chips...
             if (retVal) retVal = fread(&mySN, sizeof(mySN),1, handle);
@@ -637,6 +645,7 @@ void colecoLoadState(void)
                 if (retVal) retVal = fread(&pv1000_freqA,          sizeof(pv1000_freqA),         1, handle);
                 if (retVal) retVal = fread(&pv1000_freqB,          sizeof(pv1000_freqB),         1, handle);
                 if (retVal) retVal = fread(&pv1000_freqC,          sizeof(pv1000_freqC),         1, handle);
+                pv1000_redraw_all = 1;
             }
             else if (adam_mode)  // Big enough that we will not read this if we are not ADAM
             {
@@ -700,7 +709,10 @@ void colecoLoadState(void)
             }
 
             last_mega_bank = 199;   // Force load of bank if needed
+            if (bSuperSimplifiedMemory == 2) simplified_bank = MemoryMap[6];   // The banked simplified driver reads the Mega Cart window from here
             last_tape_pos = 9999;   // Force tape position to show
+            SoundQueueReset();      // Drop any pending sound writes - the chips are as they were saved
+            if (paged_rom && !PagedROMLoadTags(spare)) retVal = 0;     // Put the same ROM banks back in the frames the slot pointers were saved with
         }
         else retVal = 0;
 
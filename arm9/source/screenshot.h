@@ -4,6 +4,7 @@
 #include <nds/ndstypes.h>
 
 extern bool screenshot(void);
+extern bool screenshotbmp(const char* filename);
 
 typedef struct {
     u16 type;                       /* Magic identifier            */
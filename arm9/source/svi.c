@@ -79,7 +79,7 @@ unsigned char cpu_readport_svi(register unsigned short Port)
 
           myAY.ayPortAIn = ~joy1;
       }
-      return ay38910DataR(&myAY);
+      return SoundReadAY();
   }
   else if (Port == 0x98)
   {
@@ -376,7 +376,7 @@ void cpu_writeport_svi(register unsigned short Port,register unsigned char Value
     }
     else if (Port == 0x8C)
     {
-        ay38910DataW(Value, &myAY);
+        SoundWriteAY(Value);
         if (myAY.ayRegIndex == 14)
         {
             myAY.ayPortAIn = Value;
@@ -0,0 +1,330 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "vdpcapture.h"
+#include "cpu/z80/Z80_interface.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "screenshot.h"
+#include "CRC32.h"
+#include "lzav.h"
+
+// ---------------------------------------------------------------------------------------
+// The capture is held in RAM and only compressed and written out when the recording is
+// stopped so that the disk never gets touched while the game is running. Only the DSi
+// has the memory to spare for this - 1MB is about 170,000 port accesses which is anywhere
+// from a few seconds to half a minute of play depending on how much VRAM is rewritten.
+// ---------------------------------------------------------------------------------------
+#define VDP_CAP_BUF_SIZE    (1024*1024)
+
+u8  *vdp_cap_buffer = 0;
+u32  vdp_cap_len    = 0;                // Bytes of vdp_cap_buffer in use
+u32  vdp_cap_count  = 0;                // Number of entries recorded
+char vdp_cap_last[64] = {0};            // The last capture written - this is what gets replayed
+
+// ---------------------------------------------------------------------------------------
+// Snapshot the VDP state and start logging every port access. Returns 0 if there is
+// no memory for a capture (DS-Lite/Phat).
+// ---------------------------------------------------------------------------------------
+u8 VDPCaptureStart(void)
+{
+    if (!isDSiMode()) return 0;
+
+    if (!vdp_cap_buffer) vdp_cap_buffer = malloc(VDP_CAP_BUF_SIZE);
+    if (!vdp_cap_buffer) return 0;
+
+    tVDPCapHeader *hdr = (tVDPCapHeader *)vdp_cap_buffer;
+    memset(hdr, 0x00, sizeof(tVDPCapHeader));
+    hdr->magic        = VDP_CAP_MAGIC;
+    hdr->version      = VDP_CAP_VERSION;
+    hdr->machine_mode = machine_mode;
+    hdr->num_lines    = tms_num_lines;
+    hdr->start_line   = tms_start_line;
+    hdr->cpu_line     = tms_cpu_line;
+    hdr->VAddr        = VAddr;
+    memcpy(hdr->VDP, VDP, 8);
+    hdr->VDPStatus    = VDPStatus;
+    hdr->VDPDlatch    = VDPDlatch;
+    hdr->VDPCtrlLatch = VDPCtrlLatch;
+
+    memcpy(vdp_cap_buffer + sizeof(tVDPCapHeader), pVDPVidMem, 0x4000);
+
+    vdp_cap_len   = sizeof(tVDPCapHeader) + 0x4000;
+    vdp_cap_count = 0;
+
+    vdp_log_active |= VDP_LOG_CAPTURE;
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Record one port access. Called from the tms9918a.c port handlers only while the
+// VDP_LOG_CAPTURE bit is set. When the buffer fills we just stop recording - the
+// capture so far is still written out when the user stops it.
+// ---------------------------------------------------------------------------------------
+ITCM_CODE void VDPCapture(u8 type, u8 value)
+{
+    if ((vdp_cap_len + sizeof(tVDPCapEntry)) > VDP_CAP_BUF_SIZE)
+    {
+        vdp_log_active &= ~VDP_LOG_CAPTURE;
+        return;
+    }
+
+    tVDPCapEntry *entry = (tVDPCapEntry *)(vdp_cap_buffer + vdp_cap_len);
+    entry->line  = CurLine;
+    entry->cycle = (creativision_mode ? 0 : (tms_cpu_line - CPU.ICount));
+    entry->type  = type;
+    entry->value = value;
+
+    vdp_cap_len += sizeof(tVDPCapEntry);
+    vdp_cap_count++;
+}
+
+// ---------------------------------------------------------------------------------------
+// Stop recording and write the compressed capture out to a time-stamped .vdp file in
+// the same way that screenshots are named. Returns 0 if nothing could be written.
+// ---------------------------------------------------------------------------------------
+u8 VDPCaptureStop(void)
+{
+    char capPath[64];
+    u8 bOK = 0;
+
+    vdp_log_active &= ~VDP_LOG_CAPTURE;
+
+    if (!vdp_cap_buffer || !vdp_cap_len) return 0;
+
+    ((tVDPCapHeader *)vdp_cap_buffer)->entries = vdp_cap_count;
+
+    int max_len = lzav_compress_bound(vdp_cap_len);
+    u8 *comp = malloc(max_len);
+    if (comp)
+    {
+        int comp_len = lzav_compress_default(vdp_cap_buffer, comp, vdp_cap_len, max_len);
+
+        time_t unixTime = time(NULL);
+        struct tm* timeStruct = gmtime((const time_t *)&unixTime);
+        sprintf(capPath, "VDPCAP-%02d-%02d-%04d-%02d-%02d-%02d.vdp", timeStruct->tm_mday, timeStruct->tm_mon+1, timeStruct->tm_year+1900, timeStruct->tm_hour, timeStruct->tm_min, timeStruct->tm_sec);
+
+        FILE *fp = fopen(capPath, "wb");
+        if (fp)
+        {
+            fwrite(&vdp_cap_len, sizeof(vdp_cap_len), 1, fp);
+            fwrite(&comp_len,    sizeof(comp_len),    1, fp);
+            fwrite(comp,         comp_len,            1, fp);
+            fclose(fp);
+            strcpy(vdp_cap_last, capPath);
+            bOK = 1;
+        }
+        free(comp);
+    }
+
+    // Give the memory back - the capture buffer is only needed while recording
+    free(vdp_cap_buffer);
+    vdp_cap_buffer = 0;
+    vdp_cap_len    = 0;
+
+    return bOK;
+}
+
+// ---------------------------------------------------------------------------------------
+// Replay a capture through the VDP port functions and the line renderers exactly as the
+// CPU core would have driven them - but with nothing else running - so the time spent
+// in the VDP can be measured on its own and the frames compared run to run. Each frame
+// is timed with TIMER3 at 33.5MHz/64 (so a frame must not take more than 125ms) and the
+// results go to a .txt report alongside the capture, with the last frame saved as a .bmp.
+// The live VDP state is put back afterwards so the game just carries on.
+//
+// If there is a .gld file alongside the capture (the .txt report from a known-good build
+// renamed) each frame CRC is checked against it - a renderer change that alters even one
+// pixel of any frame shows up as VDP_REPLAY_DIFF and the frames are marked in the report.
+//
+// The capture only has line granularity for rendering: an access stamped with visible
+// line N is applied after line N is drawn, which is what Loop9918() does. Accesses in
+// the top border or vertical blank don't draw anything. If the recording started in
+// the middle of a frame, the first frame is drawn from the start state and is partial.
+// ---------------------------------------------------------------------------------------
+u8 VDPReplay(const char *filename)
+{
+    char outPath[64];
+    u32 raw_len = 0, comp_len = 0;
+    char goldLine[64];
+    u8 bOK = VDP_REPLAY_FAIL;
+
+    if (vdp_cap_buffer) return VDP_REPLAY_FAIL;     // Not while we're recording
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return VDP_REPLAY_FAIL;
+    fread(&raw_len,  sizeof(raw_len),  1, fp);
+    fread(&comp_len, sizeof(comp_len), 1, fp);
+
+    u8 *raw  = ((raw_len >= (sizeof(tVDPCapHeader) + 0x4000)) ? malloc(raw_len) : 0);
+    u8 *comp = (raw ? malloc(comp_len) : 0);
+    u8 *live = (comp ? malloc(0x4000) : 0);
+    if (!live || (fread(comp, comp_len, 1, fp) != 1) || (lzav_decompress(comp, raw, comp_len, raw_len) != (int)raw_len))
+    {
+        fclose(fp);
+        if (live) free(live);
+        if (comp) free(comp);
+        if (raw)  free(raw);
+        return VDP_REPLAY_FAIL;
+    }
+    fclose(fp);
+    free(comp);
+
+    tVDPCapHeader *hdr = (tVDPCapHeader *)raw;
+    tVDPCapEntry *entry = (tVDPCapEntry *)(raw + sizeof(tVDPCapHeader) + 0x4000);
+    if ((hdr->magic != VDP_CAP_MAGIC) || (hdr->version != VDP_CAP_VERSION) ||
+        (hdr->entries > ((raw_len - sizeof(tVDPCapHeader) - 0x4000) / sizeof(tVDPCapEntry))))
+    {
+        free(live);
+        free(raw);
+        return VDP_REPLAY_FAIL;
+    }
+
+    // The golden CRCs and the report sit next to the capture - same name, .gld and .txt
+    strncpy(outPath, filename, sizeof(outPath)-5);
+    outPath[sizeof(outPath)-5] = 0;
+    char *ext = strrchr(outPath, '.');
+    if (ext) *ext = 0;
+    else ext = outPath + strlen(outPath);
+    strcat(outPath, ".gld");
+    FILE *gold = fopen(outPath, "r");
+    *ext = 0;
+    strcat(outPath, ".txt");
+    FILE *report = fopen(outPath, "w");
+
+    // ------------------------------------------------------------
+    // Save what the running game has in the VDP and switch off any
+    // logging so the replay doesn't end up in the deferred log.
+    // ------------------------------------------------------------
+    u8  saveVDP[8];
+    u16 saveVAddr   = VAddr;
+    u16 saveCurLine = CurLine;
+    u8  saveStatus  = VDPStatus;
+    u8  saveDlatch  = VDPDlatch;
+    u8  saveCtrl    = VDPCtrlLatch;
+    u8  saveActive  = vdp_log_active;
+    u16 saveIRQ     = CPU.IRequest;
+    memcpy(saveVDP, VDP, 8);
+    memcpy(live, pVDPVidMem, 0x4000);
+    vdp_log_active = 0;
+
+    // And put the VDP into the state the capture started from
+    memcpy(pVDPVidMem, raw + sizeof(tVDPCapHeader), 0x4000);
+    for (u8 reg=0; reg<8; reg++) Write9918(reg, hdr->VDP[reg]);
+    VAddr        = hdr->VAddr;
+    VDPStatus    = hdr->VDPStatus;
+    VDPDlatch    = hdr->VDPDlatch;
+    VDPCtrlLatch = hdr->VDPCtrlLatch;
+    vdp_dirty = VDP_DIRTY_FRAMES;
+    vdp_changed = 1;
+
+    if (report) fprintf(report, "VDP REPLAY %s  MODE %d  LINES %d  START %d  ENTRIES %lu\nFRAME    TICKS     USEC       CRC\n",
+                        filename, hdr->machine_mode, hdr->num_lines, hdr->start_line, hdr->entries);
+
+    u32 frames = 0, total = 0, slowest = 0, golden = 0, differ = 0;
+    u8  line = 0;                       // Next visible line to draw
+    u16 end_line = hdr->start_line + 192;
+
+    SelectSink9918();
+    TIMER3_CR = 0; TIMER3_DATA = 0; TIMER3_CR = TIMER_ENABLE | TIMER_DIV_64;
+
+    for (u32 i=0; i<hdr->entries; i++, entry++)
+    {
+        if ((entry->line >= hdr->start_line) && (entry->line < end_line))
+        {
+            CurLine = entry->line;
+            while (line <= (entry->line - hdr->start_line)) RefreshLine(line++);
+        }
+
+        switch (entry->type)
+        {
+            case VDP_CAP_DATA_WR: WrData9918(entry->value); break;
+            case VDP_CAP_CTRL_WR: WrCtrl9918(entry->value); break;
+            case VDP_CAP_DATA_RD: RdData9918();             break;
+            case VDP_CAP_CTRL_RD: RdCtrl9918();             break;
+            case VDP_CAP_FRAME:
+            {
+                while (line < 192) RefreshLine(line++);
+                u32 ticks = TIMER3_DATA;
+                u32 crc = getCRC32(XBuf, 256*192);
+                colecoUpdateScreen();
+
+                // Find the next frame line in the golden report - anything else in there is skipped
+                u32 goldFrame, goldTicks, goldUsec, goldCRC;
+                u8 mismatch = 0;
+                while (gold && fgets(goldLine, sizeof(goldLine), gold))
+                {
+                    if (sscanf(goldLine, "%lu %lu %lu %lX", &goldFrame, &goldTicks, &goldUsec, &goldCRC) != 4) continue;
+                    golden++;
+                    if (goldCRC != crc) {mismatch = 1; differ++;}
+                    break;
+                }
+                if (report) fprintf(report, "%5lu %8lu %8lu  %08lX%s\n", frames, ticks, (ticks * 64000) / 33514, crc, (mismatch ? " *" : ""));
+                total += ticks;
+                if (ticks > slowest) slowest = ticks;
+                frames++;
+                line = 0;
+                SelectSink9918();
+                TIMER3_CR = 0; TIMER3_DATA = 0; TIMER3_CR = TIMER_ENABLE | TIMER_DIV_64;
+                break;
+            }
+        }
+    }
+    TIMER3_CR = 0;
+
+    if (report)
+    {
+        if (frames) fprintf(report, "FRAMES %lu  AVERAGE %lu USEC  SLOWEST %lu USEC\n", frames, ((total / frames) * 64000) / 33514, (slowest * 64000) / 33514);
+        if (gold)   fprintf(report, "GOLDEN %lu CHECKED  %lu DIFFER%s\n", golden, differ, ((golden != frames) ? "  (FRAME COUNT DIFFERS)" : ""));
+        fclose(report);
+        bOK = ((differ || (gold && (golden != frames))) ? VDP_REPLAY_DIFF : VDP_REPLAY_OK);
+    }
+    if (gold) fclose(gold);
+
+    // The last replayed frame is still on screen - keep a picture of it
+    if (frames)
+    {
+        swiWaitForVBlank();
+        *ext = 0;
+        strcat(outPath, ".bmp");
+        screenshotbmp(outPath);
+    }
+
+    // ------------------------------------------------------------
+    // Put the running game's VDP back just as it was.
+    // ------------------------------------------------------------
+    memcpy(pVDPVidMem, live, 0x4000);
+    for (u8 reg=0; reg<8; reg++) Write9918(reg, saveVDP[reg]);
+    VAddr          = saveVAddr;
+    CurLine        = saveCurLine;
+    VDPStatus      = saveStatus;
+    VDPDlatch      = saveDlatch;
+    VDPCtrlLatch   = saveCtrl;
+    vdp_log_active = saveActive;
+    CPU.IRequest   = saveIRQ;
+    InvalidateTextCache();
+    vdp_dirty = VDP_DIRTY_FRAMES;
+    vdp_changed = 1;
+
+    free(live);
+    free(raw);
+
+    return bOK;
+}
+
+// End of file
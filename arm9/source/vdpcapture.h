@@ -0,0 +1,75 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _VDPCAPTURE_H_
+#define _VDPCAPTURE_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// VDP capture file (.vdp) - a recording of every VDP port access so that a rendering
+// problem can be reproduced without the CPU core. The file on disk is:
+//
+//    u32  raw_len            Length of the uncompressed capture
+//    u32  comp_len           Length of the lzav compressed capture that follows
+//    u8   data[comp_len]     lzav_compress_default() of the raw capture
+//
+// The raw capture is a tVDPCapHeader, then the 16K of VRAM as it was when recording
+// started, then hdr.entries tVDPCapEntry records in the order the accesses happened.
+// To replay: restore the registers and VRAM, then feed each entry to the matching
+// port function, rendering line (entry.line - start_line) whenever the line changes.
+// VDPReplay() does just that on the DS and writes the frame times and CRCs out, checking
+// the CRCs against a golden list from a known-good build if there is one.
+// ---------------------------------------------------------------------------------------
+#define VDP_CAP_MAGIC       0x43504456  // "VDPC"
+#define VDP_CAP_VERSION     1
+
+#define VDP_CAP_DATA_WR     0           // WrData9918(value)
+#define VDP_CAP_CTRL_WR     1           // WrCtrl9918(value)
+#define VDP_CAP_DATA_RD     2           // RdData9918() returned value
+#define VDP_CAP_CTRL_RD     3           // RdCtrl9918() returned value (status)
+#define VDP_CAP_FRAME       4           // End of the visible frame (vertical blank)
+
+#define VDP_REPLAY_FAIL     0           // VDPReplay() - capture couldn't be read or report written
+#define VDP_REPLAY_OK       1           // Replayed (and matched the .gld frame CRCs if there are any)
+#define VDP_REPLAY_DIFF     2           // Replayed but one or more frames differ from the .gld CRCs
+
+typedef struct {
+    u32 magic;                          // VDP_CAP_MAGIC
+    u16 version;                        // VDP_CAP_VERSION
+    u16 machine_mode;                   // MODE_COLECO, MODE_MSX, etc.
+    u16 num_lines;                      // tms_num_lines - 262 for NTSC, 312 for PAL
+    u16 start_line;                     // tms_start_line - first visible line
+    u16 cpu_line;                       // tms_cpu_line - CPU cycles per scanline
+    u16 VAddr;
+    u8  VDP[8];
+    u8  VDPStatus;
+    u8  VDPDlatch;
+    u8  VDPCtrlLatch;
+    u8  reserved;
+    u32 entries;                        // Number of tVDPCapEntry records
+} PACKED tVDPCapHeader;
+
+typedef struct {
+    u16 line;                           // CurLine when the access happened
+    s16 cycle;                          // CPU cycles into the line (0 for the 6502 CreatiVision)
+    u8  type;                           // VDP_CAP_xxx
+    u8  value;                          // Value written or read
+} PACKED tVDPCapEntry;
+
+extern u8  *vdp_cap_buffer;                // Non-zero while a capture is held in memory
+extern char vdp_cap_last[];                // Filename of the last capture written (empty if none)
+
+extern u8   VDPCaptureStart(void);
+extern u8   VDPCaptureStop(void);
+extern void VDPCapture(u8 type, u8 value);
+extern u8   VDPReplay(const char *filename);
+
+#endif // _VDPCAPTURE_H_
@@ -0,0 +1,280 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "colecogeneric.h"
+#include "vgmlog.h"
+
+// ---------------------------------------------------------------------------------------
+// Commands are gathered in RAM and written out once a second from the main loop (or
+// right away if the buffer ever fills) so the SD card is never touched from inside the
+// emulated sound port writes. 16K is many seconds of even the busiest digitized speech.
+// ---------------------------------------------------------------------------------------
+#define VGM_BUF_SIZE        (16*1024)
+
+#define VGM_SN_CLOCK        3579545     // Colecovision, SG-1000, Sord M5, etc.
+#define VGM_SN_CLOCK_CV     2000000     // The CreatiVision runs its SN76489 at 2MHz
+#define VGM_AY_CLOCK        1789772     // MSX, SVI, Einstein and the Super Game Module
+#define VGM_SCC_CLOCK       1789772
+
+u8   vgm_log_active = 0;
+
+FILE *vgm_fp        = 0;
+u8   *vgm_buffer    = 0;
+u32   vgm_buf_len   = 0;                // Bytes of vgm_buffer waiting to be written
+u32   vgm_file_len  = 0;                // Bytes written to the file so far
+u32   vgm_samples   = 0;                // Total 44.1kHz samples of waits written
+u32   vgm_last_pos  = 0;                // sound_emu_pos as of the last wait
+u64   vgm_time_frac = 0;                // Emulated time not yet turned into a whole VGM sample
+u8    vgm_chips     = 0;                // VGM_CHIP_xxx bits of the chips the log uses
+
+static void VGMLogFlush(void)
+{
+    if (vgm_buf_len)
+    {
+        fwrite(vgm_buffer, vgm_buf_len, 1, vgm_fp);
+        vgm_file_len += vgm_buf_len;
+        vgm_buf_len = 0;
+    }
+}
+
+static inline void VGMLogPut(u8 data)
+{
+    if (vgm_buf_len == VGM_BUF_SIZE) VGMLogFlush();
+    vgm_buffer[vgm_buf_len++] = data;
+}
+
+// ---------------------------------------------------------------------------------------
+// Turn the emulated time since the last command into VGM wait commands. The emulated time
+// is in output samples (24.8) so it is scaled to 44.1kHz keeping the remainder so that
+// nothing is lost to rounding no matter how many writes there are.
+// ---------------------------------------------------------------------------------------
+static void VGMLogWait(u32 pos)
+{
+    s32 delta = (s32)(pos - vgm_last_pos);
+    if (delta <= 0) return;             // Same moment as the last command
+    vgm_time_frac += (u64)delta * VGM_RATE;
+    vgm_last_pos = pos;
+
+    u32 wait = vgm_time_frac / ((sample_rate*2) << 8);
+    vgm_time_frac -= (u64)wait * ((sample_rate*2) << 8);
+    vgm_samples += wait;
+
+    while (wait)
+    {
+        if      (wait == 735) {VGMLogPut(VGM_CMD_WAIT_NTSC); wait = 0;}
+        else if (wait == 882) {VGMLogPut(VGM_CMD_WAIT_PAL);  wait = 0;}
+        else if (wait <= 16)  {VGMLogPut(VGM_CMD_WAIT_SHORT + wait - 1); wait = 0;}
+        else
+        {
+            u16 n = (wait > 0xFFFF) ? 0xFFFF : wait;
+            VGMLogPut(VGM_CMD_WAIT);
+            VGMLogPut(n & 0xFF);
+            VGMLogPut(n >> 8);
+            wait -= n;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// The VGM K051649 command splits the SCC up into ports - wave RAM, frequency, volume and
+// the key on/off register. The address is the same 0x00-0xFF one SCCWrite() takes.
+// ---------------------------------------------------------------------------------------
+static void VGMLogSCC(u8 adr, u8 value)
+{
+    if (adr >= 0x90) adr -= 0x10;       // 0x90-0x9F mirror the registers
+    if (adr >= 0x90) return;            // Test register - nothing a player can use
+
+    VGMLogPut(VGM_CMD_SCC);
+    if      (adr <  0x80) {VGMLogPut(0); VGMLogPut(adr);}
+    else if (adr <  0x8A) {VGMLogPut(1); VGMLogPut(adr - 0x80);}
+    else if (adr <  0x8F) {VGMLogPut(2); VGMLogPut(adr - 0x8A);}
+    else                  {VGMLogPut(3); VGMLogPut(0);}
+    VGMLogPut(value);
+}
+
+// ---------------------------------------------------------------------------------------
+// Called from the SoundWriteXX() functions while vgm_log_active is set - 'reg' is the AY
+// register or the SCC address and isn't used for the SN.
+// ---------------------------------------------------------------------------------------
+ITCM_CODE void VGMLogWrite(u8 chip, u8 reg, u8 value)
+{
+    VGMLogWait(SoundTimeNow());
+
+    vgm_chips |= chip;
+    switch (chip)
+    {
+        case VGM_CHIP_SN:
+            VGMLogPut(VGM_CMD_SN);
+            VGMLogPut(value);
+            break;
+        case VGM_CHIP_AY:
+            VGMLogPut(VGM_CMD_AY);
+            VGMLogPut(reg);
+            VGMLogPut(value);
+            break;
+        case VGM_CHIP_SCC:
+            VGMLogSCC(reg, value);
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// A log starts part way through a game so we begin it with whatever the chips are set to.
+// The SN tone registers hold the 10-bit divider shifted up by 4 (see sn76496W).
+// ---------------------------------------------------------------------------------------
+static void VGMLogChipState(u8 chips)
+{
+    if (chips & VGM_CHIP_SN)
+    {
+        const u16 *regs = &mySN.ch0Reg;
+        for (u8 ch=0; ch<3; ch++)
+        {
+            u16 tone = regs[ch<<1];
+            VGMLogWrite(VGM_CHIP_SN, 0, 0x80 | (ch << 5) | ((tone >> 4) & 0x0F));
+            VGMLogWrite(VGM_CHIP_SN, 0, (tone >> 8) & 0x3F);
+        }
+        u8 white = ((mySN.noiseFB & 0xFFFF) == (mySN.noiseType >> 16));
+        VGMLogWrite(VGM_CHIP_SN, 0, 0xE0 | (white ? 0x04:0x00) | (mySN.ch3Reg & 0x03));
+        for (u8 ch=0; ch<4; ch++)
+        {
+            VGMLogWrite(VGM_CHIP_SN, 0, 0x90 | (ch << 5) | (regs[(ch<<1)+1] & 0x0F));
+        }
+    }
+
+    if (chips & VGM_CHIP_AY)
+    {
+        for (u8 reg=0; reg<14; reg++)   // Not the I/O ports
+        {
+            VGMLogWrite(VGM_CHIP_AY, reg, sound_ay_regs[reg]);
+        }
+    }
+
+    if (chips & VGM_CHIP_SCC)
+    {
+        const u8 *state = (const u8 *)mySCC.ch0Wave;   // Wave RAM then the registers - as SCCWrite() stores them
+        for (u16 adr=0; adr<0x90; adr++)
+        {
+            VGMLogWrite(VGM_CHIP_SCC, adr, state[adr]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Open a time-stamped .vgm file in /data and start logging. 'chips' are the VGM_CHIP_xxx
+// the machine is using right now - anything the game switches on later is added as it
+// is written. Returns 0 if the file can't be created or there is no memory.
+// ---------------------------------------------------------------------------------------
+u8 VGMLogStart(u8 chips)
+{
+    char vgmPath[64];
+
+    if (vgm_log_active) return 1;
+
+    if (!vgm_buffer) vgm_buffer = malloc(VGM_BUF_SIZE);
+    if (!vgm_buffer) return 0;
+
+    DIR* dir = opendir("/data");
+    if (dir) closedir(dir);
+    else mkdir("/data", 0777);
+
+    time_t unixTime = time(NULL);
+    struct tm* timeStruct = gmtime((const time_t *)&unixTime);
+    sprintf(vgmPath, "/data/VGM-%02d-%02d-%04d-%02d-%02d-%02d.vgm", timeStruct->tm_mday, timeStruct->tm_mon+1, timeStruct->tm_year+1900, timeStruct->tm_hour, timeStruct->tm_min, timeStruct->tm_sec);
+
+    vgm_fp = fopen(vgmPath, "wb");
+    if (!vgm_fp)
+    {
+        free(vgm_buffer);
+        vgm_buffer = 0;
+        return 0;
+    }
+
+    memset(vgm_buffer, 0x00, VGM_DATA_START);   // The header is filled in when we stop
+    vgm_buf_len   = VGM_DATA_START;
+    vgm_file_len  = 0;
+    vgm_samples   = 0;
+    vgm_time_frac = 0;
+    vgm_last_pos  = SoundTimeNow();
+    vgm_chips     = 0;
+
+    VGMLogChipState(chips);
+    vgm_log_active = 1;
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once a second from the main loop - the waits are brought up to date (so a long
+// silence can't overflow the emulated time) and the commands so far are written out.
+// ---------------------------------------------------------------------------------------
+void VGMLogService(void)
+{
+    if (!vgm_log_active) return;
+
+    VGMLogWait(sound_emu_pos);
+    VGMLogFlush();
+}
+
+// ---------------------------------------------------------------------------------------
+// Finish the log and go back to fill in the header now that we know how long it is and
+// which chips were used. Returns 0 if there was no log running.
+// ---------------------------------------------------------------------------------------
+u8 VGMLogStop(void)
+{
+    u32 hdr[VGM_DATA_START/4];
+
+    if (!vgm_log_active) return 0;
+    vgm_log_active = 0;
+
+    VGMLogWait(SoundTimeNow());
+    VGMLogPut(VGM_CMD_END);
+    VGMLogFlush();
+
+    memset(hdr, 0x00, sizeof(hdr));
+    hdr[0x00/4] = VGM_IDENT;
+    hdr[0x04/4] = vgm_file_len - 0x04;          // Relative offset to the end of the file
+    hdr[0x08/4] = VGM_VERSION;
+    hdr[0x18/4] = vgm_samples;
+    hdr[0x24/4] = (myConfig.isPAL ? 50 : 60);
+    hdr[0x34/4] = VGM_DATA_START - 0x34;        // Relative offset to the commands
+    if (vgm_chips & VGM_CHIP_SN)
+    {
+        hdr[0x0C/4] = (creativision_mode ? VGM_SN_CLOCK_CV : VGM_SN_CLOCK);
+        hdr[0x28/4] = 0x0003 | (15 << 16) | (0x05 << 24);   // SN76489AN feedback, 15-bit shift register, no stereo
+    }
+    if (vgm_chips & VGM_CHIP_AY)
+    {
+        hdr[0x74/4] = VGM_AY_CLOCK;
+        hdr[0x78/4] = 0x00 | (0x01 << 8);       // AY8910, legacy output
+    }
+    if (vgm_chips & VGM_CHIP_SCC) hdr[0x9C/4] = VGM_SCC_CLOCK;
+
+    fseek(vgm_fp, 0, SEEK_SET);
+    fwrite(hdr, sizeof(hdr), 1, vgm_fp);
+    fclose(vgm_fp);
+    vgm_fp = 0;
+
+    free(vgm_buffer);
+    vgm_buffer = 0;
+
+    return 1;
+}
+
+// End of file
@@ -0,0 +1,47 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _VGMLOG_H_
+#define _VGMLOG_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// VGM sound log (.vgm) - every write to the SN76489, AY-3-8910 and Konami SCC with the
+// emulated time between them, in the standard VGM 1.61 format that any VGM player (or
+// the C sound cores on a PC) can play back. A few bytes per write instead of recording
+// the output means it costs next to nothing while the game is running.
+// ---------------------------------------------------------------------------------------
+#define VGM_IDENT           0x206D6756  // "Vgm "
+#define VGM_VERSION         0x00000161
+#define VGM_RATE            44100       // VGM waits are always in 44.1kHz samples
+#define VGM_DATA_START      0x100       // Size of the header - the commands follow it
+
+#define VGM_CMD_SN          0x50        // dd        SN76489 write
+#define VGM_CMD_WAIT        0x61        // nnnn      Wait n samples
+#define VGM_CMD_WAIT_NTSC   0x62        //           Wait 735 samples (1/60th of a second)
+#define VGM_CMD_WAIT_PAL    0x63        //           Wait 882 samples (1/50th of a second)
+#define VGM_CMD_END         0x66        //           End of sound data
+#define VGM_CMD_WAIT_SHORT  0x70        //           0x7n - wait n+1 samples
+#define VGM_CMD_AY          0xA0        // aa dd     AY8910 write register aa
+#define VGM_CMD_SCC         0xD2        // pp aa dd  K051649 write port pp register aa
+
+#define VGM_CHIP_SN         0x01        // Same bits as the mixer's MIX_SRC_xxx
+#define VGM_CHIP_AY         0x02
+#define VGM_CHIP_SCC        0x04
+
+extern u8   vgm_log_active;             // Non-zero while a VGM log is being recorded
+
+extern u8   VGMLogStart(u8 chips);
+extern u8   VGMLogStop(void);
+extern void VGMLogService(void);
+extern void VGMLogWrite(u8 chip, u8 reg, u8 value);
+
+#endif // _VGMLOG_H_
@@ -0,0 +1,151 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "hoststubs.h"
+
+// ---------------------------------------------------------------------------------------
+// Host check of the frame blend kernel colecoBlendWords() in framesink.c - here built
+// with its SSE2 (x86) or NEON (ARM) 128-bit path. Every length from 0 to 67 words at
+// every word offset of the three buffers has to give the same result as a plain word
+// OR and must not touch a word past the end. Then the kernel is timed against the plain
+// loop on a whole frame, and the real CPU blend in colecoUpdateScreen() is timed with
+// every row changed and with only a few rows changed.
+//
+//    blendtest
+// ---------------------------------------------------------------------------------------
+#define MAX_WORDS       67
+#define FRAME_WORDS     (256*192/4)
+#define TIMED_BLENDS    2000
+
+#define GUARD           0xDEADBEEF
+
+static double NowUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+// The plain word OR the kernel has to match - kept out of the auto-vectorizer so the
+// timing compares against what the loop was before
+__attribute__((optimize("no-tree-vectorize")))
+static void PlainBlendWords(u32 *p1, u32 *p2, u32 *destP, u32 words)
+{
+    for (u32 i=0; i<words; i++) destP[i] = (p1[i] | p2[i]);
+}
+
+static u32 CheckKernel(void)
+{
+    static u32 a[MAX_WORDS+4], b[MAX_WORDS+4], dest[MAX_WORDS+8], expected[MAX_WORDS];
+    u32 failed = 0, checked = 0;
+
+    srand(0x9918);
+    for (u32 i=0; i<MAX_WORDS+4; i++)
+    {
+        a[i] = ((u32)rand() << 16) ^ (u32)rand();
+        b[i] = ((u32)rand() << 16) ^ (u32)rand();
+    }
+
+    for (u32 words=0; words<=MAX_WORDS; words++)
+    {
+        for (u32 offset=0; offset<4; offset++)
+        {
+            u32 *pa = a + offset, *pb = b + ((offset + 1) & 3), *pd = dest + 1 + ((offset + 2) & 3);
+
+            for (u32 i=0; i<MAX_WORDS+8; i++) dest[i] = GUARD;
+            PlainBlendWords(pa, pb, expected, words);
+            colecoBlendWords(pa, pb, pd, words);
+
+            u8 bOK = (pd[-1] == GUARD) && (pd[words] == GUARD) && !memcmp(pd, expected, words * sizeof(u32));
+            if (!bOK)
+            {
+                if (failed < 10) printf("BLEND %2u WORDS AT OFFSET %u - WRONG\n", words, offset);
+                failed++;
+            }
+            checked++;
+        }
+    }
+    printf("%u lengths and offsets checked against the plain OR - %u wrong\n\n", checked, failed);
+
+    return failed;
+}
+
+static void TimeKernel(void)
+{
+    static u32 a[FRAME_WORDS], b[FRAME_WORDS], dest[FRAME_WORDS];
+    for (u32 i=0; i<FRAME_WORDS; i++) {a[i] = i * 0x01010101; b[i] = ~i;}
+
+    double start = NowUsec();
+    for (u32 n=0; n<TIMED_BLENDS; n++) PlainBlendWords(a, b, dest, FRAME_WORDS);
+    double plain = (NowUsec() - start) / TIMED_BLENDS;
+
+    start = NowUsec();
+    for (u32 n=0; n<TIMED_BLENDS; n++) colecoBlendWords(a, b, dest, FRAME_WORDS);
+    double kernel = (NowUsec() - start) / TIMED_BLENDS;
+
+    printf("WHOLE FRAME (%u WORDS)     USEC/BLEND\n", FRAME_WORDS);
+    printf("plain word OR              %8.2f\n", plain);
+    printf("colecoBlendWords           %8.2f   (%.1fx)\n\n", kernel, plain / kernel);
+}
+
+// The CPU blend as the emulator runs it - two frames go through colecoUpdateScreen()
+// and the second one ORs the changed rows of both into the display
+static double TimeUpdateScreen(u8 rows)
+{
+    HostReset9918();
+    myConfig.frameBlend = FRAME_BLEND_CPU;
+    SelectSink9918();
+    memset(XBuf_A, 0x15, 256*192);
+    memset(XBuf_B, 0x42, 256*192);
+
+    double start = NowUsec();
+    for (u32 n=0; n<TIMED_BLENDS; n++)
+    {
+        for (u8 pass=0; pass<2; pass++)
+        {
+            for (u8 y=0; y<rows; y++) vdp_dirty_rows[y>>5] |= (1 << (y&31));
+            vdp_changed = 1;
+            colecoUpdateScreen();
+        }
+    }
+    return (NowUsec() - start) / TIMED_BLENDS;
+}
+
+int main(int argc, char *argv[])
+{
+    u32 failed = CheckKernel();
+
+    TimeKernel();
+
+    printf("colecoUpdateScreen() CPU BLEND    USEC/PAIR\n");
+    printf("all 192 rows changed              %8.2f\n", TimeUpdateScreen(192));
+    printf("16 rows changed                   %8.2f\n", TimeUpdateScreen(16));
+
+    u8 *display = (u8*)VDP_SINK_BG3;
+    if ((display[0] != (0x15 | 0x42)) || (display[15*256+255] != (0x15 | 0x42)))
+    {
+        printf("colecoUpdateScreen() didn't blend the changed rows into the display\n");
+        failed++;
+    }
+
+    return (failed ? 1 : 0);
+}
+
+// End of file
@@ -0,0 +1,103 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "CRC32.h"
+#include "hostpng.h"
+
+// ---------------------------------------------------------------------------------------
+// Minimal PNG writer for the host tools - no zlib needed. The image data goes out as a
+// single uncompressed ("stored") deflate block which is plenty for a 48K frame. The
+// chunk CRCs are the same CRC32 the emulator uses (getCRC32) carried across the chunk
+// type and data.
+// ---------------------------------------------------------------------------------------
+#define PNG_W   256
+#define PNG_H   192
+#define PNG_RAW ((PNG_W+1)*PNG_H)       // Each row is a filter byte (0 = none) and the pixels
+
+static u8 png_buf[PNG_RAW + 64];
+
+static void PutBE32(u8 *p, u32 v)
+{
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void WriteChunk(FILE *fp, const char *type, const u8 *data, u32 len)
+{
+    u8 hdr[8];
+    PutBE32(hdr, len);
+    memcpy(hdr+4, type, 4);
+    fwrite(hdr, 8, 1, fp);
+    if (len) fwrite(data, len, 1, fp);
+
+    // The chunk CRC covers the type and the data - run getCRC32() over both in one go
+    static u8 crcbuf[4 + PNG_RAW + 64];
+    memcpy(crcbuf, type, 4);
+    if (len) memcpy(crcbuf+4, data, len);
+    u8 crc[4];
+    PutBE32(crc, getCRC32(crcbuf, len+4));
+    fwrite(crc, 4, 1, fp);
+}
+
+u8 WriteFramePNG(const char *filename, const u8 *frame, const u8 *palette, u16 colors)
+{
+    static const u8 signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    u8 ihdr[13];
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) return 0;
+
+    fwrite(signature, 8, 1, fp);
+
+    PutBE32(ihdr+0, PNG_W);
+    PutBE32(ihdr+4, PNG_H);
+    ihdr[8]  = 8;       // 8 bits per pixel
+    ihdr[9]  = 3;       // Paletted
+    ihdr[10] = 0;       // Deflate
+    ihdr[11] = 0;       // Adaptive filtering (we only use filter 0)
+    ihdr[12] = 0;       // Not interlaced
+    WriteChunk(fp, "IHDR", ihdr, sizeof(ihdr));
+
+    WriteChunk(fp, "PLTE", palette, colors*3);
+
+    // zlib header, one final stored block holding all the rows, then the Adler-32 of the rows
+    u8 *p = png_buf;
+    *p++ = 0x78; *p++ = 0x01;
+    *p++ = 0x01;
+    *p++ = PNG_RAW & 0xFF; *p++ = PNG_RAW >> 8;
+    *p++ = ~PNG_RAW & 0xFF; *p++ = (~PNG_RAW >> 8) & 0xFF;
+    u32 a = 1, b = 0;
+    for (int y=0; y<PNG_H; y++)
+    {
+        *p = 0;
+        b = (b + a) % 65521;
+        for (int x=0; x<PNG_W; x++)
+        {
+            p[1+x] = frame[y*PNG_W + x];
+            a = (a + p[1+x]) % 65521;
+            b = (b + a) % 65521;
+        }
+        p += PNG_W+1;
+    }
+    PutBE32(p, (b << 16) | a);
+    p += 4;
+    WriteChunk(fp, "IDAT", png_buf, p - png_buf);
+
+    WriteChunk(fp, "IEND", 0, 0);
+
+    u8 bOK = (ferror(fp) == 0);
+    fclose(fp);
+    return bOK;
+}
+
+// End of file
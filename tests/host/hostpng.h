@@ -0,0 +1,19 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _HOSTPNG_H_
+#define _HOSTPNG_H_
+
+#include <nds.h>
+
+// Write a 256x192 frame of color indexes as a paletted PNG - palette is 'colors' RGB triplets
+extern u8 WriteFramePNG(const char *filename, const u8 *frame, const u8 *palette, u16 colors);
+
+#endif // _HOSTPNG_H_
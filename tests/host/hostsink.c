@@ -0,0 +1,153 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "colecoDS.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "CRC32.h"
+#include "hostsink.h"
+#include "hostpng.h"
+
+// ---------------------------------------------------------------------------------------
+// Consumers for what the real frame sink (framesink.c) puts on the "display" - which on
+// the host is host_vram in place of the BG3/BG2 bitmaps. After each colecoUpdateScreen()
+// the picture is taken from there just as the DS would show it and handed to a running
+// hash, a raw dump and/or PNG files. With FRAME_BLEND_LAYERS the DS shows both layers
+// mixed half and half (color 0 is transparent) so each shown pixel is the pair of color
+// indexes, and the PNG palette has all 256 mixes.
+//
+// Every frame is also checked against XBuf_A/XBuf_B: with the blend off BG3 has to be
+// the last frame drawn, with LAYERS each layer has to be its own XBuf and with the CPU
+// blend BG3 has to be the OR of both once the pair is complete. A row that the dirty
+// row tracking failed to send out shows up in host_sink_errors.
+// ---------------------------------------------------------------------------------------
+u32 host_sink_frames = 0;
+u32 host_sink_hash   = 0;
+u32 host_sink_errors = 0;
+
+static u8    sink_consumers = 0;
+static FILE *sink_raw       = 0;
+static const char *sink_png = 0;
+static u32   sink_png_every = 1;
+
+static u8 shown[256*192];
+static u8 blended[256*192];
+static u8 palette[256*3];
+
+u8 HostSinkOpen(u8 consumers, const char *rawFile, const char *pngPrefix, u32 pngEvery)
+{
+    sink_consumers   = consumers;
+    sink_png         = pngPrefix;
+    sink_png_every   = (pngEvery ? pngEvery : 1);
+    host_sink_frames = 0;
+    host_sink_hash   = 0;
+    host_sink_errors = 0;
+
+    if (consumers & HOST_SINK_RAW)
+    {
+        sink_raw = fopen(rawFile, "wb");
+        if (!sink_raw) return 0;
+    }
+
+    return 1;
+}
+
+void HostSinkClose(void)
+{
+    if (sink_raw) fclose(sink_raw);
+    sink_raw = 0;
+    sink_consumers = 0;
+}
+
+// The 16 TMS9918A colors, or for the LAYERS blend every pair of them mixed half and half
+static u16 SetupPalette(void)
+{
+    if (vdp_sink != FRAME_BLEND_LAYERS)
+    {
+        memcpy(palette, TMS9918A_palette, 16*3);
+        return 16;
+    }
+
+    for (u16 i=0; i<256; i++)
+    {
+        u8 bg3 = i & 0x0F, bg2 = i >> 4;
+        for (u8 c=0; c<3; c++)
+        {
+            u8 a = TMS9918A_palette[bg3*3+c], b = TMS9918A_palette[bg2*3+c];
+            palette[i*3+c] = (!bg3 ? b : (!bg2 ? a : (a + b) / 2));
+        }
+    }
+    return 256;
+}
+
+static void CheckDisplay(void)
+{
+    const u8 *bg3 = (u8*)VDP_SINK_BG3;
+    const u8 *bg2 = (u8*)VDP_SINK_BG2;
+    u8 bOK = 1;
+
+    if (vdp_sink == FRAME_BLEND_LAYERS)
+    {
+        bOK = !memcmp(bg3, XBuf_A, 256*192) && !memcmp(bg2, XBuf_B, 256*192);
+    }
+    else if (vdp_sink == FRAME_BLEND_CPU)
+    {
+        if (XBuf != XBuf_A) return;                 // Half way through a pair - nothing new is shown
+        for (u32 i=0; i<256*192; i++) blended[i] = XBuf_A[i] | XBuf_B[i];
+        bOK = !memcmp(bg3, blended, 256*192);
+    }
+    else
+    {
+        bOK = !memcmp(bg3, XBuf, 256*192);
+    }
+
+    if (!bOK)
+    {
+        if (!host_sink_errors) fprintf(stderr, "hostsink: frame %u - the display doesn't match what was drawn\n", host_sink_frames);
+        host_sink_errors++;
+    }
+}
+
+void HostSinkFrame(void)
+{
+    const u8 *bg3 = (u8*)VDP_SINK_BG3;
+    const u8 *bg2 = (u8*)VDP_SINK_BG2;
+    char pngPath[256];
+
+    CheckDisplay();
+
+    if (vdp_sink == FRAME_BLEND_LAYERS)
+        for (u32 i=0; i<256*192; i++) shown[i] = (bg3[i] & 0x0F) | ((bg2[i] & 0x0F) << 4);
+    else
+        for (u32 i=0; i<256*192; i++) shown[i] = bg3[i] & 0x0F;
+
+    if (sink_consumers & HOST_SINK_HASH)
+    {
+        u32 chain[2] = {host_sink_hash, getCRC32(shown, 256*192)};
+        host_sink_hash = getCRC32((u8*)chain, sizeof(chain));
+    }
+
+    if (sink_raw) fwrite(shown, 256*192, 1, sink_raw);
+
+    if ((sink_consumers & HOST_SINK_PNG) && ((host_sink_frames % sink_png_every) == 0))
+    {
+        u16 colors = SetupPalette();
+        snprintf(pngPath, sizeof(pngPath), "%s%05u.png", sink_png, host_sink_frames);
+        if (!WriteFramePNG(pngPath, shown, palette, colors)) fprintf(stderr, "hostsink: can't write %s\n", pngPath);
+    }
+
+    host_sink_frames++;
+}
+
+// End of file
@@ -0,0 +1,28 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _HOSTSINK_H_
+#define _HOSTSINK_H_
+
+#include <nds.h>
+
+#define HOST_SINK_HASH      0x01        // Chain the CRC32 of every frame shown into host_sink_hash
+#define HOST_SINK_RAW       0x02        // Append every frame shown to a raw file (256x192 bytes each)
+#define HOST_SINK_PNG       0x04        // Write every Nth frame shown as a PNG
+
+extern u32  host_sink_frames;           // Frames seen since HostSinkOpen()
+extern u32  host_sink_hash;             // HOST_SINK_HASH result
+extern u32  host_sink_errors;           // Frames where the display didn't hold what the renderer drew
+
+extern u8   HostSinkOpen(u8 consumers, const char *rawFile, const char *pngPrefix, u32 pngEvery);
+extern void HostSinkFrame(void);
+extern void HostSinkClose(void);
+
+#endif // _HOSTSINK_H_
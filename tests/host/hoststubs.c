@@ -0,0 +1,75 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "colecoDS.h"
+#include "colecogeneric.h"
+#include "cpu/z80/Z80_interface.h"
+#include "cpu/z80/ctc.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "hoststubs.h"
+
+// ---------------------------------------------------------------------------------------
+// Everything tms9918a.c, vdpcapture.c and CRC32.c reach outside of themselves, so that
+// the renderer can be linked into a host program without the rest of the emulator. The DS registers
+// are just variables here and the machine is a plain ColecoVision with the default
+// options - the harness sets myConfig to whatever it is testing.
+// ---------------------------------------------------------------------------------------
+u16  BG_PALETTE[512];
+vu16 TIMER0_DATA, TIMER1_DATA, TIMER2_DATA, TIMER3_DATA;
+vu16 TIMER0_CR,   TIMER1_CR,   TIMER2_CR,   TIMER3_CR;
+vu16 REG_DISPCNT, REG_BLDCNT, REG_BLDALPHA, REG_BG2CNT;
+vu32 REG_BG2X, REG_BG2Y;
+vs16 REG_BG2PA, REG_BG2PB, REG_BG2PC, REG_BG2PD;
+
+u8  sg1000_mode = 0, sordm5_mode = 0, einstein_mode = 0, pv1000_mode = 0;
+u8  memotech_mode = 0, msx_mode = 0, svi_mode = 0, adam_mode = 0;
+u8  creativision_mode = 0;
+u16 machine_mode = MODE_COLECO;
+u16 vsync_wait_ticks = 0;
+
+struct Config_t       myConfig;
+struct GlobalConfig_t myGlobalConfig;
+
+Z80   CPU;
+CTC_t CTC[CTC_CHAN_MAX];
+
+u32 sound_emu_pos   = 0;
+u32 sound_line_step = 0;
+
+
+u32 MAX_CART_SIZE = 512;
+u8 *ROM_Memory    = 0;
+u32 file_size     = 0;
+
+u8 host_dsi_mode = 0;
+
+bool isDSiMode(void) {return host_dsi_mode;}
+void swiWaitForVBlank(void) {}
+void creativision_input(void) {}
+bool screenshotbmp(const char *filename) {return 0;}
+
+// The BG3/BG2 bitmaps the frame sink shows the picture in (VDP_SINK_BG3/BG2 on the host)
+u8 host_vram[0x20000] ALIGN(32);
+
+// The color look-up table lives in DS video memory at 0x068A0000 - give it host memory
+extern u32 (*lutTablehh)[16][16];
+static u32 host_lut[16][16][16];
+
+void HostReset9918(void)
+{
+    lutTablehh = host_lut;
+    Reset9918();
+}
+
+// End of file
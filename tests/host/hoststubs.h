@@ -0,0 +1,19 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _HOSTSTUBS_H_
+#define _HOSTSTUBS_H_
+
+#include <nds.h>
+
+extern u8   host_dsi_mode;                // What isDSiMode() returns - VDPCaptureStart() only records on a DSi
+extern void HostReset9918(void);          // Reset9918() with the color look-up table moved into host memory
+
+#endif // _HOSTSTUBS_H_
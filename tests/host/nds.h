@@ -0,0 +1,102 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#ifndef _HOST_NDS_H_
+#define _HOST_NDS_H_
+
+// ---------------------------------------------------------------------------------------
+// Just enough of libnds for the host test harnesses to compile the arm9 sources they
+// exercise (the VDP renderer, the C sound cores, CRC32 and the frame blend kernel)
+// unmodified with the PC compiler. The DS hardware registers are plain variables that
+// the harness stubs define - nothing here ever talks to real hardware.
+// ---------------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+typedef volatile u8  vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+typedef volatile s16 vs16;
+typedef volatile s32 vs32;
+
+#ifndef TRUE
+#define TRUE  1
+#define FALSE 0
+#endif
+
+#define ITCM_CODE                       // No tightly coupled memory on the host - .dtcm is just another data section
+#define DTCM_DATA
+#define ALIGN(n)    __attribute__((aligned(n)))
+#define PACKED      __attribute__((packed))
+#define BIT(n)      (1<<(n))
+
+#define RGB15(r,g,b)    ((r)|((g)<<5)|((b)<<10))
+
+extern u16 BG_PALETTE[512];
+
+extern vu16 TIMER0_DATA, TIMER1_DATA, TIMER2_DATA, TIMER3_DATA;
+extern vu16 TIMER0_CR,   TIMER1_CR,   TIMER2_CR,   TIMER3_CR;
+#define TIMER_ENABLE    0x80
+#define TIMER_DIV_1     0
+#define TIMER_DIV_64    1
+#define TIMER_DIV_256   2
+#define TIMER_DIV_1024  3
+
+extern vu16 REG_DISPCNT, REG_BLDCNT, REG_BLDALPHA, REG_BG2CNT;
+extern vu32 REG_BG2X, REG_BG2Y;
+extern vs16 REG_BG2PA, REG_BG2PB, REG_BG2PC, REG_BG2PD;
+#define BG_BMP8_256x256     0x4080
+#define BG_BMP_BASE(n)      ((n)<<8)
+#define BLEND_ALPHA         (1<<6)
+#define BLEND_SRC_BG2       (1<<2)
+#define BLEND_DST_BG3       (1<<11)
+#define DISPLAY_BG2_ACTIVE  (1<<10)
+#define DISPLAY_BG3_ACTIVE  (1<<11)
+
+#define KEY_A       BIT(0)
+#define KEY_B       BIT(1)
+#define KEY_SELECT  BIT(2)
+#define KEY_START   BIT(3)
+#define KEY_RIGHT   BIT(4)
+#define KEY_LEFT    BIT(5)
+#define KEY_UP      BIT(6)
+#define KEY_DOWN    BIT(7)
+#define KEY_R       BIT(8)
+#define KEY_L       BIT(9)
+#define KEY_X       BIT(10)
+#define KEY_Y       BIT(11)
+#define KEY_TOUCH   BIT(12)
+
+extern bool isDSiMode(void);
+extern void swiWaitForVBlank(void);
+
+// The host has no cache to flush and its "DMA" is a plain copy that is done at once
+static inline void DC_FlushRange(const void *base, u32 size) {}
+static inline void dmaCopyWordsAsynch(u8 channel, const void *src, void *dest, u32 size) {memcpy(dest, src, size);}
+
+// ---------------------------------------------------------------------------------------
+// The BG3 and BG2 bitmaps the frame sink draws into are 128K of host memory in place of
+// VRAM bank A at 0x06000000 - the host sink consumers look at the picture from here.
+// ---------------------------------------------------------------------------------------
+extern u8 host_vram[0x20000];
+#define VDP_SINK_BG3        ((u16*)(host_vram))
+#define VDP_SINK_BG2        ((u16*)(host_vram + 0x10000))
+
+#endif // _HOST_NDS_H_
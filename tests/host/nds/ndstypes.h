@@ -0,0 +1,2 @@
+// The libnds types all come from the host nds.h stand-in
+#include <nds.h>
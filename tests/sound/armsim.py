@@ -0,0 +1,887 @@
+#!/usr/bin/env python3
+# =====================================================================================
+# Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+#
+# Copying and distribution of this emulator, its source code and associated
+# readme files, with or without modification, are permitted in any medium without
+# royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+# Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+#
+# The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+# =====================================================================================
+#
+# Records the output of the ARM assembly sound cores (SN76496.s, AY38910.s and SCC.s)
+# for a sound script, so that soundtest can check the portable C cores against them.
+#
+# There is no ARM toolchain or DS in the host build, so this is a small ARMv5 assembler
+# and interpreter for the instructions those three files use. The .s file goes through
+# cpp with the same defines as the arm9 build (plus the ones given here), is assembled
+# into real ARM instruction words and run from memory - so the jump tables, literal
+# pools and the SCC volumes that are patched into the mixer code all work as they do on
+# the DS. memcpy and memset are done in Python.
+#
+#    armsim.py sn|ay|scc script.snd output.bin [-DSN_UPSHIFT=2 ...]
+#
+# The output is every sample the script mixes and every state it saves, in order - the
+# same stream soundtest builds from the C cores.
+# =====================================================================================
+import os
+import re
+import struct
+import subprocess
+import sys
+
+M32 = 0xFFFFFFFF
+
+CORES = {
+    'sn':  '../../arm9/source/cpu/sn76496/SN76496.s',
+    'ay':  '../../arm9/source/cpu/ay38910/AY38910.s',
+    'scc': '../../arm9/source/cpu/scc/SCC.s',
+}
+
+# Where things go in the simulated memory
+SECTION_BASE = {'.itcm': 0x00100000, '.text': 0x00200000, '.dtcm': 0x00300000,
+                '.iwram': 0x00400000, '.ewram': 0x00500000}
+CHIP      = 0x00800000
+SAVEBUF   = 0x00810000
+DEST      = 0x00900000
+DEST_SIZE = 0x00400000
+STACK_TOP = 0x00F00000
+INTRINSIC = {'memcpy': 0x00080000, 'memset': 0x00080010}
+STOP      = 0x000800F0
+MEM_SIZE  = 0x01000000
+
+COND = {'eq': 0, 'ne': 1, 'cs': 2, 'hs': 2, 'cc': 3, 'lo': 3, 'mi': 4, 'pl': 5, 'vs': 6,
+        'vc': 7, 'hi': 8, 'ls': 9, 'ge': 10, 'lt': 11, 'gt': 12, 'le': 13, 'al': 14}
+DP = {'and': 0, 'eor': 1, 'sub': 2, 'rsb': 3, 'add': 4, 'adc': 5, 'sbc': 6, 'rsc': 7,
+      'tst': 8, 'teq': 9, 'cmp': 10, 'cmn': 11, 'orr': 12, 'mov': 13, 'bic': 14, 'mvn': 15}
+SHIFT = {'lsl': 0, 'lsr': 1, 'asr': 2, 'ror': 3}
+LDM_MODE = {'ia': (0, 1), 'ib': (1, 1), 'da': (0, 0), 'db': (1, 0)}
+LDM_ALIAS = {'ldm': {'fd': 'ia', 'ed': 'ib', 'fa': 'da', 'ea': 'db'},
+             'stm': {'fd': 'db', 'ed': 'da', 'fa': 'ib', 'ea': 'ia'}}
+REGS = dict([('r%d' % i, i) for i in range(16)] + [('sp', 13), ('lr', 14), ('pc', 15), ('ip', 12), ('fp', 11)])
+
+# Longest first, so ldrb isn't read as ldr + b... and bl/b are tried last
+BASES = ['ldrsb', 'ldrsh', 'ldrb', 'ldrh', 'ldr', 'strb', 'strh', 'str', 'ldm', 'stm', 'adr',
+         'mla', 'mul'] + sorted(DP, key=len, reverse=True) + ['bx', 'bl', 'b']
+
+
+class AsmError(Exception):
+    pass
+
+
+# -------------------------------------------------------------------------------------
+# Assembler
+# -------------------------------------------------------------------------------------
+def split_mnemonic(m):
+    """Split a unified syntax mnemonic like 'ldrbne' or 'movscs' into (base, S, cond, mode)"""
+    for base in BASES:
+        if not m.startswith(base):
+            continue
+        rest = m[len(base):]
+        s, mode = 0, None
+        if base in ('ldm', 'stm'):
+            for pos in (0, len(rest) - 2):
+                mode = rest[pos:pos+2] if len(rest) >= 2 else None
+                mode = LDM_ALIAS[base].get(mode, mode)
+                if mode in LDM_MODE:
+                    rest = rest[:pos] + rest[pos+2:]
+                    break
+            else:
+                continue
+        elif base in DP or base in ('mla', 'mul'):
+            if rest.startswith('s') and (rest[1:] == '' or rest[1:] in COND):
+                s, rest = 1, rest[1:]
+            elif rest.endswith('s') and rest[:-1] in COND:
+                s, rest = 1, rest[:-1]
+        if rest == '':
+            return base, s, 14, mode
+        if rest in COND:
+            return base, s, COND[rest], mode
+    raise AsmError('unknown instruction %s' % m)
+
+
+def split_operands(text):
+    """Split on the commas that aren't inside [] or {}"""
+    ops, depth, cur = [], 0, ''
+    for ch in text:
+        if ch in '[{':
+            depth += 1
+        elif ch in ']}':
+            depth -= 1
+        if ch == ',' and depth == 0:
+            ops.append(cur.strip())
+            cur = ''
+        else:
+            cur += ch
+    if cur.strip():
+        ops.append(cur.strip())
+    return ops
+
+
+def encode_imm(value):
+    """ARM rotated 8-bit immediate - the smallest rotation, as the GNU assembler picks"""
+    value &= M32
+    for rot in range(16):
+        v = ((value << (2*rot)) | (value >> (32 - 2*rot))) & M32 if rot else value
+        if v < 256:
+            return (rot << 8) | v
+    return None
+
+
+class Assembler:
+    def __init__(self, source):
+        self.source = source
+        self.symbols = dict(INTRINSIC)
+        self.items = []                 # (section, address, kind, data, line)
+        self.pools = {}                 # section -> [expr, ...] for ldr rX,=expr
+        self.pool_addr = {}
+
+    # Expressions are C-like with the .equ, struct and label symbols
+    def eval(self, expr, required=True):
+        expr = expr.strip()
+        if expr.startswith('#'):
+            expr = expr[1:]
+        py = re.sub(r'(?<![0-9A-Za-z_])([A-Za-z_.$][\w.$]*)', lambda m: self.lookup(m.group(1), required), expr)
+        py = py.replace('/', '//')
+        try:
+            return int(eval(py, {'__builtins__': {}}))
+        except Exception:
+            if required:
+                raise AsmError('bad expression %s' % expr)
+            return 0
+
+    def lookup(self, name, required):
+        if re.match(r'0[xX][0-9A-Fa-f]+$', name):
+            return name
+        if name in self.symbols:
+            return '(%d)' % self.symbols[name]
+        if required:
+            raise AsmError('undefined symbol %s' % name)
+        return '0'
+
+    def statements(self):
+        for lineno, line in enumerate(self.source.split('\n'), 1):
+            line = line.split('//')[0]
+            for stmt in line.split(';'):
+                stmt = stmt.split('@')[0].strip()
+                while True:
+                    m = re.match(r'([A-Za-z_.$][\w.$]*):(.*)$', stmt)
+                    if not m:
+                        break
+                    yield lineno, m.group(1), None
+                    stmt = m.group(2).strip()
+                if stmt:
+                    yield lineno, None, stmt
+
+    # First pass - lay out the sections and find every symbol
+    def layout(self):
+        section, struct_at, pc = None, None, dict((s, 0) for s in SECTION_BASE)
+        for lineno, label, stmt in self.statements():
+            if label:
+                if struct_at is not None:
+                    self.symbols[label] = struct_at
+                elif section:
+                    self.symbols[label] = SECTION_BASE[section] + pc[section]
+                else:
+                    raise AsmError('line %d: label %s outside a section' % (lineno, label))
+                continue
+
+            word = stmt.split(None, 1)
+            op, args = word[0].lower(), (word[1] if len(word) > 1 else '')
+
+            if op == '.end':
+                break
+            if op in ('.global', '.type', '.syntax', '.arm'):
+                continue
+            if op == '.equ':
+                name, value = split_operands(args)
+                self.symbols[name] = self.eval(value)
+                continue
+            if op == '.struct':
+                struct_at = self.eval(args)
+                continue
+            if op == '.section':
+                section, struct_at = split_operands(args)[0], None
+                continue
+
+            size = {'.long': 4, '.short': 2, '.byte': 1}.get(op)
+            if struct_at is not None:
+                if size:
+                    struct_at += size * len(split_operands(args))
+                elif op == '.space':
+                    struct_at += self.eval(args)
+                else:
+                    raise AsmError('line %d: %s in a .struct' % (lineno, stmt))
+                continue
+
+            if section is None:
+                raise AsmError('line %d: %s outside a section' % (lineno, stmt))
+            at = pc[section]
+            if op == '.align':
+                step = 1 << self.eval(args)
+                pc[section] = (at + step - 1) & ~(step - 1)
+                self.items.append((section, SECTION_BASE[section] + at, 'pad', pc[section] - at, lineno))
+                continue
+            if size:
+                values = split_operands(args)
+                self.items.append((section, SECTION_BASE[section] + at, op, values, lineno))
+                pc[section] += size * len(values)
+                continue
+            if op == '.space':
+                n = self.eval(args)
+                self.items.append((section, SECTION_BASE[section] + at, 'pad', n, lineno))
+                pc[section] += n
+                continue
+            if op.startswith('.'):
+                raise AsmError('line %d: unsupported directive %s' % (lineno, op))
+
+            if op.startswith('ldr') and '=' in args:
+                pool = self.pools.setdefault(section, [])
+                lit = split_operands(args)[1].lstrip('=').strip()
+                if lit not in pool:
+                    pool.append(lit)
+            self.items.append((section, SECTION_BASE[section] + at, 'insn', (op, args), lineno))
+            pc[section] += 4
+
+        # The literal pools go at the end of their section, as the GNU assembler puts them
+        for section, pool in self.pools.items():
+            at = (pc[section] + 3) & ~3
+            self.pool_addr[section] = SECTION_BASE[section] + at
+            pc[section] = at + 4 * len(pool)
+        self.ends = dict((s, SECTION_BASE[s] + pc[s]) for s in pc)
+
+    # Second pass - put the instruction words and data into memory
+    def emit(self, mem):
+        for section, pool in self.pools.items():
+            for i, lit in enumerate(pool):
+                struct.pack_into('<I', mem, self.pool_addr[section] + 4*i, self.eval(lit) & M32)
+        for section, addr, kind, data, lineno in self.items:
+            try:
+                if kind == 'pad':
+                    mem[addr:addr+data] = bytes(data)
+                elif kind == 'insn':
+                    struct.pack_into('<I', mem, addr, self.encode(section, addr, *data))
+                else:
+                    fmt, size = {'.long': ('<I', 4), '.short': ('<H', 2), '.byte': ('<B', 1)}[kind]
+                    for i, v in enumerate(data):
+                        struct.pack_into(fmt, mem, addr + size*i, self.eval(v) & ((1 << (8*size)) - 1))
+            except AsmError as e:
+                raise AsmError('line %d: %s' % (lineno, e))
+
+    def reg(self, text):
+        text = text.strip().rstrip('!').lower()
+        if text not in REGS:
+            raise AsmError('not a register: %s' % text)
+        return REGS[text]
+
+    def shift(self, text):
+        """'lsl#16', 'lsr #27', 'lsl r2' or 'rrx' -> shift bits 4-11 of a register operand"""
+        text = text.strip()
+        if text.lower() == 'rrx':
+            return 3 << 5
+        m = re.match(r'(lsl|lsr|asr|ror)\s*(.*)$', text, re.I)
+        if not m:
+            raise AsmError('bad shift %s' % text)
+        kind, amount = SHIFT[m.group(1).lower()], m.group(2).strip()
+        if not amount.startswith('#') and amount.lower() in REGS:
+            return (self.reg(amount) << 8) | (kind << 5) | 0x10
+        n = self.eval(amount)
+        if kind in (1, 2) and n == 32:
+            n = 0
+        if not (0 <= n < 32) or (kind == 3 and n == 0):
+            raise AsmError('bad shift amount %s' % text)
+        if n == 0:
+            kind = 0
+        return (n << 7) | (kind << 5)
+
+    def operand2(self, ops):
+        """Returns the I bit and the 12 operand bits of a data processing instruction"""
+        if ops[0].startswith('#'):
+            return None, self.eval(ops[0])
+        bits = self.reg(ops[0])
+        if len(ops) > 1:
+            bits |= self.shift(ops[1])
+        return 0, bits
+
+    def encode(self, section, addr, op, args):
+        base, s, cond, mode = split_mnemonic(op)
+        ops = split_operands(args)
+        c = cond << 28
+
+        if base in DP:
+            code = DP[base]
+            if code in (13, 15):                        # mov, mvn
+                rd, rn, rest = self.reg(ops[0]), 0, ops[1:]
+            elif 8 <= code <= 11:                       # tst, teq, cmp, cmn
+                rd, rn, rest, s = 0, self.reg(ops[0]), ops[1:], 1
+            elif len(ops) == 2 or (len(ops) == 3 and re.match(r'(lsl|lsr|asr|ror|rrx)', ops[2].lower())):
+                rd = rn = self.reg(ops[0])              # Two operand form: ands r1,#0x40
+                rest = ops[1:]
+            else:
+                rd, rn, rest = self.reg(ops[0]), self.reg(ops[1]), ops[2:]
+            imm, bits = self.operand2(rest)
+            if imm is None:
+                enc = encode_imm(bits)
+                if enc is None:                         # Let the assembler pick the inverse op
+                    alt = {13: (15, ~bits), 15: (13, ~bits), 0: (14, ~bits), 14: (0, ~bits),
+                           10: (11, -bits), 11: (10, -bits), 4: (2, -bits), 2: (4, -bits)}.get(code)
+                    if alt and encode_imm(alt[1]) is not None:
+                        code, enc = alt[0], encode_imm(alt[1])
+                    else:
+                        raise AsmError('immediate 0x%X can not be encoded' % (bits & M32))
+                return c | (1 << 25) | (code << 21) | (s << 20) | (rn << 16) | (rd << 12) | enc
+            return c | (code << 21) | (s << 20) | (rn << 16) | (rd << 12) | bits
+
+        if base in ('mul', 'mla'):
+            rd, rm, rs = self.reg(ops[0]), self.reg(ops[1]), self.reg(ops[2])
+            rn, a = (self.reg(ops[3]), 1) if base == 'mla' else (0, 0)
+            return c | (a << 21) | (s << 20) | (rd << 16) | (rn << 12) | (rs << 8) | 0x90 | rm
+
+        if base in ('b', 'bl'):
+            off = (self.eval(ops[0]) - (addr + 8)) >> 2
+            return c | (0b101 << 25) | ((base == 'bl') << 24) | (off & 0xFFFFFF)
+
+        if base == 'bx':
+            return c | 0x012FFF10 | self.reg(ops[0])
+
+        if base == 'adr':
+            off = self.eval(ops[1]) - (addr + 8)
+            code, off = (4, off) if off >= 0 else (2, -off)
+            enc = encode_imm(off)
+            if enc is None:
+                raise AsmError('adr out of range')
+            return c | (1 << 25) | (code << 21) | (15 << 16) | (self.reg(ops[0]) << 12) | enc
+
+        if base in ('ldm', 'stm'):
+            p, u = LDM_MODE[mode]
+            rn = ops[0].strip()
+            w = rn.endswith('!')
+            regs = 0
+            for part in ops[1:]:
+                part = part.strip().strip('{}')
+                for r in split_operands(part):
+                    if '-' in r:
+                        lo, hi = r.split('-')
+                        for i in range(self.reg(lo), self.reg(hi) + 1):
+                            regs |= 1 << i
+                    elif r:
+                        regs |= 1 << self.reg(r)
+            return (c | (0b100 << 25) | (p << 24) | (u << 23) | (w << 21) | ((base == 'ldm') << 20) |
+                    (self.reg(rn) << 16) | regs)
+
+        # Single data transfers
+        load = base.startswith('ldr')
+        rd = self.reg(ops[0])
+        if ops[1].startswith('='):
+            lit = self.pool_addr[section] + 4 * self.pools[section].index(ops[1][1:].strip())
+            ops = [ops[0], '[pc, #%d]' % (lit - (addr + 8))]
+        m = re.match(r'\[([^\]]*)\](!?)$', ops[1])
+        if not m:
+            raise AsmError('bad address %s' % ops[1])
+        inner = split_operands(m.group(1))
+        if len(ops) > 2:                                # Post-indexed: [rn], #offset
+            if len(inner) != 1 or m.group(2):
+                raise AsmError('bad address %s' % ','.join(ops[1:]))
+            p, w, offs = 0, 0, ops[2:]
+        else:
+            p, w, offs = 1, int(m.group(2) == '!'), inner[1:]
+        rn = self.reg(inner[0])
+        u, imm, off = 1, True, 0
+        if offs:
+            first = offs[0].strip()
+            if first.startswith('#'):
+                off = self.eval(first)
+                if off < 0:
+                    u, off = 0, -off
+            else:
+                imm = False
+                if first.startswith('-'):
+                    u, first = 0, first[1:]
+                off = self.reg(first)
+                if len(offs) > 1:
+                    off |= self.shift(offs[1])
+
+        if base in ('ldr', 'str', 'ldrb', 'strb'):
+            b = int(base.endswith('b'))
+            if imm and off > 0xFFF:
+                raise AsmError('offset out of range')
+            return (c | (1 << 26) | ((not imm) << 25) | (p << 24) | (u << 23) | (b << 22) | (w << 21) |
+                    (load << 20) | (rn << 16) | (rd << 12) | off)
+
+        sh = {'ldrh': 0b01, 'strh': 0b01, 'ldrsb': 0b10, 'ldrsh': 0b11}[base]
+        if imm:
+            if off > 0xFF:
+                raise AsmError('offset out of range')
+            low = ((off >> 4) << 8) | (off & 0xF)
+        else:
+            if off > 15:
+                raise AsmError('halfword transfers can not shift the offset')
+            low = off
+        return (c | (p << 24) | (u << 23) | (int(imm) << 22) | (w << 21) | (load << 20) | (rn << 16) |
+                (rd << 12) | 0x90 | (sh << 5) | low)
+
+
+# -------------------------------------------------------------------------------------
+# Interpreter - decodes instruction words from memory into closures. A store into the
+# code throws the decoded instruction away so patched code runs as patched.
+# -------------------------------------------------------------------------------------
+class Machine:
+    def __init__(self, mem, code_lo, code_hi):
+        self.mem = mem
+        self.R = [0] * 16
+        self.F = [0, 0, 0, 0]                           # N, Z, C, V
+        self.cache = {}
+        self.code_lo, self.code_hi = code_lo, code_hi
+        self.executed = 0
+        self.intrinsics = {INTRINSIC['memcpy']: self.memcpy, INTRINSIC['memset']: self.memset}
+
+    # Memory - ARMv5 rotates an unaligned word load and ignores the low bits of a store
+    def ld32(self, a):
+        if a & 3:
+            v = struct.unpack_from('<I', self.mem, a & ~3)[0]
+            r = 8 * (a & 3)
+            return ((v >> r) | (v << (32 - r))) & M32
+        return struct.unpack_from('<I', self.mem, a)[0]
+
+    def ld16(self, a):
+        if a & 1:
+            raise AsmError('unaligned halfword load at 0x%08X' % a)
+        return struct.unpack_from('<H', self.mem, a)[0]
+
+    def st32(self, a, v):
+        a &= ~3
+        struct.pack_into('<I', self.mem, a, v & M32)
+        if self.code_lo <= a < self.code_hi:
+            self.cache.pop(a, None)
+
+    def st16(self, a, v):
+        if a & 1:
+            raise AsmError('unaligned halfword store at 0x%08X' % a)
+        struct.pack_into('<H', self.mem, a, v & 0xFFFF)
+        if self.code_lo <= a < self.code_hi:
+            self.cache.pop(a & ~3, None)
+
+    def st8(self, a, v):
+        self.mem[a] = v & 0xFF
+        if self.code_lo <= a < self.code_hi:
+            self.cache.pop(a & ~3, None)
+
+    def memcpy(self):
+        R = self.R
+        d, s, n = R[0], R[1], R[2]
+        self.mem[d:d+n] = self.mem[s:s+n]
+        for a in range(d & ~3, d + n, 4):
+            if self.code_lo <= a < self.code_hi:
+                self.cache.pop(a, None)
+
+    def memset(self):
+        R = self.R
+        d, v, n = R[0], R[1], R[2]
+        self.mem[d:d+n] = bytes([v & 0xFF]) * n
+
+    def cond(self, c):
+        F = self.F
+        return [lambda: F[1], lambda: not F[1], lambda: F[2], lambda: not F[2],
+                lambda: F[0], lambda: not F[0], lambda: F[3], lambda: not F[3],
+                lambda: F[2] and not F[1], lambda: (not F[2]) or F[1],
+                lambda: F[0] == F[3], lambda: F[0] != F[3],
+                lambda: (not F[1]) and F[0] == F[3], lambda: F[1] or F[0] != F[3],
+                None][c]
+
+    def shifter(self, w):
+        """Returns a function giving (value, carry out) of a data processing operand 2"""
+        R, F = self.R, self.F
+        if w & (1 << 25):
+            rot, imm = ((w >> 8) & 0xF) * 2, w & 0xFF
+            val = ((imm >> rot) | (imm << (32 - rot))) & M32 if rot else imm
+            if rot == 0:
+                return lambda: (val, F[2])
+            carry = val >> 31
+            return lambda: (val, carry)
+
+        rm, kind = w & 0xF, (w >> 5) & 3
+        if w & 0x10:                                    # Shift by register
+            rs = (w >> 8) & 0xF
+
+            def by_reg():
+                v, n = R[rm], R[rs] & 0xFF
+                if n == 0:
+                    return v, F[2]
+                if kind == 0:
+                    return ((v << n) & M32, (v >> (32 - n)) & 1) if n < 32 else (0, v & 1 if n == 32 else 0)
+                if kind == 1:
+                    return (v >> n, (v >> (n - 1)) & 1) if n < 32 else (0, v >> 31 if n == 32 else 0)
+                if kind == 2:
+                    sv = v - (1 << 32) if v >> 31 else v
+                    return ((sv >> n) & M32, (sv >> (n - 1)) & 1) if n < 32 else ((sv >> 31) & M32, v >> 31)
+                n &= 31
+                if n == 0:
+                    return v, v >> 31
+                return ((v >> n) | (v << (32 - n))) & M32, (v >> (n - 1)) & 1
+            return by_reg
+
+        n = (w >> 7) & 0x1F
+        if kind == 0:
+            if n == 0:
+                return lambda: (R[rm], F[2])
+            return lambda: ((R[rm] << n) & M32, (R[rm] >> (32 - n)) & 1)
+        if kind == 1:
+            if n == 0:
+                return lambda: (0, R[rm] >> 31)
+            return lambda: (R[rm] >> n, (R[rm] >> (n - 1)) & 1)
+        if kind == 2:
+            if n == 0:
+                return lambda: ((0xFFFFFFFF if R[rm] >> 31 else 0), R[rm] >> 31)
+
+            def asr():
+                v = R[rm]
+                sv = v - (1 << 32) if v >> 31 else v
+                return (sv >> n) & M32, (sv >> (n - 1)) & 1
+            return asr
+        if n == 0:
+            return lambda: ((F[2] << 31) | (R[rm] >> 1), R[rm] & 1)
+        return lambda: (((R[rm] >> n) | (R[rm] << (32 - n))) & M32, (R[rm] >> (n - 1)) & 1)
+
+    def decode(self, pc):
+        w = self.ld32(pc)
+        cond = self.cond(w >> 28)
+        if (w >> 28) == 15:
+            raise AsmError('unconditional instruction space at 0x%08X' % pc)
+
+        if (w & 0x0FFFFFF0) == 0x012FFF10:
+            f = self.d_bx(w)
+        elif (w & 0x0FC000F0) == 0x00000090:
+            f = self.d_mul(w)
+        elif (w & 0x0E000090) == 0x00000090 and (w & 0x60):
+            f = self.d_halfword(w)
+        elif (w >> 26) & 3 == 0:
+            f = self.d_dataproc(w)
+        elif (w >> 26) & 3 == 1:
+            if (w & (1 << 25)) and (w & 0x10):
+                raise AsmError('undefined instruction at 0x%08X' % pc)
+            f = self.d_single(w)
+        elif (w >> 25) & 7 == 4:
+            f = self.d_block(w)
+        elif (w >> 25) & 7 == 5:
+            f = self.d_branch(w)
+        else:
+            raise AsmError('unsupported instruction 0x%08X at 0x%08X' % (w, pc))
+
+        if cond:
+            def conditional(pc):
+                return f(pc) if cond() else pc + 4
+            self.cache[pc] = conditional
+        else:
+            self.cache[pc] = f
+        return self.cache[pc]
+
+    def d_bx(self, w):
+        R, rm = self.R, w & 0xF
+
+        def bx(pc):
+            if R[rm] & 1:
+                raise AsmError('bx to thumb code at 0x%08X' % pc)
+            return R[rm]
+        return bx
+
+    def d_branch(self, w):
+        R = self.R
+        off = w & 0xFFFFFF
+        off = (off - (1 << 24) if off & 0x800000 else off) << 2
+        if w & (1 << 24):
+            def bl(pc):
+                R[14] = pc + 4
+                return (pc + 8 + off) & M32
+            return bl
+        return lambda pc: (pc + 8 + off) & M32
+
+    def d_mul(self, w):
+        R, F = self.R, self.F
+        rd, rn, rs, rm = (w >> 16) & 0xF, (w >> 12) & 0xF, (w >> 8) & 0xF, w & 0xF
+        acc, s = (w >> 21) & 1, (w >> 20) & 1
+
+        def mul(pc):
+            r = (R[rm] * R[rs] + (R[rn] if acc else 0)) & M32
+            R[rd] = r
+            if s:
+                F[0], F[1] = r >> 31, int(r == 0)
+            return pc + 4
+        return mul
+
+    def d_dataproc(self, w):
+        R, F = self.R, self.F
+        op, s = (w >> 21) & 0xF, (w >> 20) & 1
+        rn, rd = (w >> 16) & 0xF, (w >> 12) & 0xF
+        op2 = self.shifter(w)
+        if s and rd == 15:
+            raise AsmError('movs pc is not supported')
+
+        def logical(r, carry):
+            if s:
+                F[0], F[1], F[2] = r >> 31, int(r == 0), carry
+
+        def add(a, b, c):
+            full = a + b + c
+            r = full & M32
+            if s:
+                F[0], F[1], F[2], F[3] = r >> 31, int(r == 0), full >> 32, (((a ^ r) & (b ^ r)) >> 31) & 1
+            return r
+
+        def sub(a, b, c):                               # a - b - (1 - c)
+            full = a - b - (1 - c)
+            r = full & M32
+            if s:
+                F[0], F[1], F[2], F[3] = r >> 31, int(r == 0), int(full >= 0), (((a ^ b) & (a ^ r)) >> 31) & 1
+            return r
+
+        def run(pc):
+            b, carry = op2()
+            a = R[rn]
+            if op == 0:
+                r = a & b; logical(r, carry)
+            elif op == 1:
+                r = a ^ b; logical(r, carry)
+            elif op == 2:
+                r = sub(a, b, 1)
+            elif op == 3:
+                r = sub(b, a, 1)
+            elif op == 4:
+                r = add(a, b, 0)
+            elif op == 5:
+                r = add(a, b, F[2])
+            elif op == 6:
+                r = sub(a, b, F[2])
+            elif op == 7:
+                r = sub(b, a, F[2])
+            elif op == 8:
+                logical(a & b, carry); return pc + 4
+            elif op == 9:
+                logical(a ^ b, carry); return pc + 4
+            elif op == 10:
+                sub(a, b, 1); return pc + 4
+            elif op == 11:
+                add(a, b, 0); return pc + 4
+            elif op == 12:
+                r = a | b; logical(r, carry)
+            elif op == 13:
+                r = b; logical(r, carry)
+            elif op == 14:
+                r = a & ~b & M32; logical(r, carry)
+            else:
+                r = ~b & M32; logical(r, carry)
+            R[rd] = r
+            return r if rd == 15 else pc + 4
+        return run
+
+    def transfer(self, pc, rd, rn, addr, p, w, final, load, size, signed):
+        R = self.R
+        a = addr if p else R[rn]
+        if load:
+            if size == 4:
+                v = self.ld32(a)
+            elif size == 2:
+                v = self.ld16(a)
+                if signed and v & 0x8000:
+                    v |= 0xFFFF0000
+            else:
+                v = self.mem[a]
+                if signed and v & 0x80:
+                    v |= 0xFFFFFF00
+        else:
+            v = R[rd] + (4 if rd == 15 else 0)          # A stored pc is the instruction + 12
+            if size == 4:
+                self.st32(a, v)
+            elif size == 2:
+                self.st16(a, v)
+            else:
+                self.st8(a, v)
+        if (not p) or w:
+            if load and rn == rd:
+                raise AsmError('load with writeback to the base at 0x%08X' % pc)
+            R[rn] = final
+        if load:
+            R[rd] = v
+            if rd == 15:
+                if v & 1:
+                    raise AsmError('load to pc of a thumb address at 0x%08X' % pc)
+                return v & ~3
+        return pc + 4
+
+    def d_single(self, w):
+        R = self.R
+        p, u, b, wb, load = (w >> 24) & 1, (w >> 23) & 1, (w >> 22) & 1, (w >> 21) & 1, (w >> 20) & 1
+        rn, rd = (w >> 16) & 0xF, (w >> 12) & 0xF
+        size = 1 if b else 4
+        if w & (1 << 25):
+            off = self.shifter(w & ~(1 << 25))
+        else:
+            imm = w & 0xFFF
+            off = lambda: (imm, 0)
+
+        def single(pc):
+            o = off()[0]
+            final = (R[rn] + o if u else R[rn] - o) & M32
+            return self.transfer(pc, rd, rn, final, p, wb, final, load, size, False)
+        return single
+
+    def d_halfword(self, w):
+        R = self.R
+        p, u, imm, wb, load = (w >> 24) & 1, (w >> 23) & 1, (w >> 22) & 1, (w >> 21) & 1, (w >> 20) & 1
+        rn, rd, sh = (w >> 16) & 0xF, (w >> 12) & 0xF, (w >> 5) & 3
+        if not load and sh != 1:
+            raise AsmError('ldrd/strd are not supported')
+        size, signed = (2, sh == 3) if sh != 2 else (1, True)
+        off_imm, rm = ((w >> 4) & 0xF0) | (w & 0xF), w & 0xF
+
+        def halfword(pc):
+            o = off_imm if imm else R[rm]
+            final = (R[rn] + o if u else R[rn] - o) & M32
+            return self.transfer(pc, rd, rn, final, p, wb, final, load, size, signed)
+        return halfword
+
+    def d_block(self, w):
+        R = self.R
+        p, u, wb, load = (w >> 24) & 1, (w >> 23) & 1, (w >> 21) & 1, (w >> 20) & 1
+        rn, regs = (w >> 16) & 0xF, [i for i in range(16) if w & (1 << i)]
+        if w & (1 << 22):
+            raise AsmError('ldm/stm with ^ is not supported')
+        n = len(regs)
+
+        def block(pc):
+            base = R[rn]
+            start = base + (4 if p else 0) if u else base - 4 * n + (0 if p else 4)
+            final = (base + 4 * n if u else base - 4 * n) & M32
+            target = None
+            if load:
+                values = [self.ld32(start + 4 * i) for i in range(n)]
+                if wb:
+                    R[rn] = final
+                for r, v in zip(regs, values):
+                    R[r] = v
+                    if r == 15:
+                        if v & 1:
+                            raise AsmError('ldm to pc of a thumb address at 0x%08X' % pc)
+                        target = v & ~3
+            else:
+                for i, r in enumerate(regs):
+                    self.st32(start + 4 * i, R[r] + (4 if r == 15 else 0))
+                if wb:
+                    R[rn] = final
+            return target if target is not None else pc + 4
+        return block
+
+    def call(self, addr, *args, limit=1 << 30):
+        R = self.R
+        for i, a in enumerate(args):
+            R[i] = a & M32
+        R[13], R[14] = STACK_TOP, STOP
+        pc, cache, intrinsics = addr, self.cache, self.intrinsics
+        count = 0
+        while pc != STOP:
+            if pc in intrinsics:
+                intrinsics[pc]()
+                pc = R[14]
+                continue
+            f = cache.get(pc) or self.decode(pc)
+            R[15] = pc + 8
+            pc = f(pc)
+            count += 1
+            if count > limit:
+                raise AsmError('no return after %d instructions' % limit)
+        self.executed += count
+        if R[13] != STACK_TOP:
+            raise AsmError('stack is off by %d after the call' % (R[13] - STACK_TOP))
+        return R[0]
+
+
+# -------------------------------------------------------------------------------------
+# Sound scripts - one command per line, '#' starts a comment
+#
+#    RESET [type]     reset the chip (the SN76496 takes the chip type)
+#    W value          sn76496W
+#    REG reg value    ay38910IndexW(reg) then ay38910DataW(value)
+#    INDEX value      ay38910IndexW
+#    DATA value       ay38910DataW
+#    WR address value SCCWrite
+#    READ [address]   ay38910DataR / SCCRead - one byte of output
+#    MIX count        run the mixer for count samples - count 16-bit samples of output
+#    SAVE             save the state - the saved bytes are output
+#    LOAD             load the state last saved
+# -------------------------------------------------------------------------------------
+def run_script(chip, script, defines):
+    here = os.path.dirname(os.path.abspath(__file__))
+    core = os.path.normpath(os.path.join(here, CORES[chip]))
+    cpp = ['cpp', '-P', '-x', 'assembler-with-cpp', '-D__arm__', '-DNDS'] + defines + [core]
+    source = subprocess.run(cpp, check=True, capture_output=True, text=True).stdout
+
+    asm = Assembler(source)
+    asm.layout()
+    mem = bytearray(MEM_SIZE)
+    asm.emit(mem)
+    code_lo, code_hi = min(SECTION_BASE.values()), max(asm.ends.values())
+    cpu = Machine(mem, code_lo, code_hi)
+    sym = asm.symbols
+    prefix = {'sn': 'sn76496', 'ay': 'ay38910', 'scc': 'SCC'}[chip]
+    out = bytearray()
+    saved = 0
+
+    for lineno, line in enumerate(open(script), 1):
+        words = line.split('#')[0].split()
+        if not words:
+            continue
+        cmd, args = words[0].upper(), [int(a, 0) for a in words[1:]]
+        if cmd == 'RESET':
+            if chip == 'sn':
+                cpu.call(sym['sn76496Reset'], args[0] if args else 0, CHIP)
+            else:
+                cpu.call(sym[prefix + 'Reset'], CHIP)
+        elif cmd == 'W' and chip == 'sn':
+            cpu.call(sym['sn76496W'], args[0] & 0xFF, CHIP)
+        elif cmd == 'REG' and chip == 'ay':
+            cpu.call(sym['ay38910IndexW'], args[0] & 0xFF, CHIP)
+            cpu.call(sym['ay38910DataW'], args[1] & 0xFF, CHIP)
+        elif cmd == 'INDEX' and chip == 'ay':
+            cpu.call(sym['ay38910IndexW'], args[0] & 0xFF, CHIP)
+        elif cmd == 'DATA' and chip == 'ay':
+            cpu.call(sym['ay38910DataW'], args[0] & 0xFF, CHIP)
+        elif cmd == 'WR' and chip == 'scc':
+            cpu.call(sym['SCCWrite'], args[1] & 0xFF, args[0] & 0xFFFF, CHIP)
+        elif cmd == 'READ' and chip == 'ay':
+            out.append(cpu.call(sym['ay38910DataR'], CHIP) & 0xFF)
+        elif cmd == 'READ' and chip == 'scc':
+            out.append(cpu.call(sym['SCCRead'], args[0] & 0xFFFF, CHIP) & 0xFF)
+        elif cmd == 'MIX':
+            n = args[0]
+            if not (0 < n and 2 * n + 2 <= DEST_SIZE):
+                raise AsmError('%s:%d: bad MIX count' % (script, lineno))
+            mem[DEST:DEST + 2*n + 2] = b'\xA5' * (2*n + 2)
+            cpu.call(sym[prefix + 'Mixer'], n, DEST, CHIP)
+            if mem[DEST + 2*n:DEST + 2*n + 2] != b'\xA5\xA5':
+                raise AsmError('%s:%d: the mixer wrote past %d samples' % (script, lineno, n))
+            out += mem[DEST:DEST + 2*n]
+        elif cmd == 'SAVE':
+            saved = cpu.call(sym[prefix + 'SaveState'], SAVEBUF, CHIP)
+            out += mem[SAVEBUF:SAVEBUF + saved]
+        elif cmd == 'LOAD':
+            cpu.call(sym[prefix + 'LoadState'], CHIP, SAVEBUF)
+        else:
+            raise AsmError('%s:%d: unknown command for %s: %s' % (script, lineno, chip, line.strip()))
+
+    return out, cpu.executed
+
+
+def main(argv):
+    if len(argv) < 4 or argv[1] not in CORES:
+        sys.stderr.write('usage: armsim.py sn|ay|scc script.snd output.bin [-Ddefine ...]\n')
+        return 2
+    out, executed = run_script(argv[1], argv[2], argv[4:])
+    with open(argv[3], 'wb') as f:
+        f.write(out)
+    print('%-3s %-28s %7d bytes  %9d instructions  %s' % (argv[1], ' '.join(argv[4:]) or '(no defines)',
+                                                          len(out), executed, argv[3]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
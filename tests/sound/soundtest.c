@@ -0,0 +1,285 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colecoDS.h"
+#include "cpu/sn76496/SN76496.h"
+#include "cpu/ay38910/AY38910.h"
+#include "cpu/scc/SCC.h"
+
+// ---------------------------------------------------------------------------------------
+// Host check of the portable C sound cores (SN76496_C.c, AY38910_C.c and SCC_C.c) against
+// their ARM assembly versions. A sound script (sn.snd, ay.snd, scc.snd) is run through
+// the C core and every sample mixed, every register read and every saved state has to
+// be the same as what the assembly core gave for the same script - recorded in golden/
+// by armsim.py with the same oversampling defines this program is built with. Then the
+// C mixer is timed so SN_UPSHIFT, AY_UPSHIFT and SCCMULT can be picked with numbers.
+//
+//    soundtest sn|ay|scc script.snd golden.bin
+// ---------------------------------------------------------------------------------------
+#ifndef SN_UPSHIFT
+#define SN_SHIFT        0
+#else
+#define SN_SHIFT        SN_UPSHIFT
+#endif
+#ifndef AY_UPSHIFT
+#define AY_SHIFT        0
+#else
+#define AY_SHIFT        AY_UPSHIFT
+#endif
+#ifndef SCCMULT
+#define SCC_MULT        16
+#else
+#define SCC_MULT        SCCMULT
+#endif
+
+#define MAX_MIX         0x10000
+#define TIMED_SAMPLES   2000000
+#define TIMED_CHUNK     512             // About what the DS mixes per call
+
+enum {CHIP_SN, CHIP_AY, CHIP_SCC};
+
+static SN76496 sn;
+static AY38910 ay;
+static SCC     scc;
+
+static s16 mixBuf[MAX_MIX + 1];
+static u8  saveBuf[256];
+
+static u8 *golden;
+static u32 goldenLen, goldenPos;
+static u32 failed;
+
+static double NowUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+// ---------------------------------------------------------------------------------------
+// The output of each command has to match the next 'len' bytes of the golden stream
+// ---------------------------------------------------------------------------------------
+static void Expect(const void *data, u32 len, u8 bSamples, const char *script, u32 lineno, const char *cmd)
+{
+    const u8 *got = (const u8 *)data;
+    const u8 *want = golden + goldenPos;
+
+    if (goldenPos + len > goldenLen)
+    {
+        if (!failed) printf("%s:%u: %s - the golden output ends here\n", script, lineno, cmd);
+        failed++;
+        goldenPos = goldenLen;
+        return;
+    }
+    goldenPos += len;
+    if (!memcmp(got, want, len)) return;
+
+    if (failed < 5)
+    {
+        u32 i = 0;
+        while (got[i] == want[i]) i++;
+        if (bSamples)
+        {
+            i >>= 1;
+            printf("%s:%u: %s - sample %u is %d, the asm core gave %d\n", script, lineno, cmd, i,
+                   ((const s16 *)got)[i], (s16)(want[2*i] | (want[2*i+1] << 8)));
+        }
+        else printf("%s:%u: %s - byte %u is %02X, the asm core gave %02X\n", script, lineno, cmd, i, got[i], want[i]);
+    }
+    failed++;
+}
+
+static u32 RunScript(u8 chip, const char *script)
+{
+    char line[256], cmd[16];
+    u32 lineno = 0, samples = 0;
+
+    FILE *fp = fopen(script, "r");
+    if (!fp) return 0;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = 0;
+
+        char *p = line;
+        long arg[2] = {0, 0};
+        int n = 0;
+        if (sscanf(p, "%15s", cmd) != 1) continue;
+        p = strstr(p, cmd) + strlen(cmd);
+        for (char *end; n < 2; n++, p = end)
+        {
+            arg[n] = strtol(p, &end, 0);
+            if (end == p) break;
+        }
+
+        if (!strcmp(cmd, "RESET"))
+        {
+            if (chip == CHIP_SN)      sn76496Reset(arg[0], &sn);
+            else if (chip == CHIP_AY) ay38910Reset(&ay);
+            else                      SCCReset(&scc);
+        }
+        else if (!strcmp(cmd, "W") && (chip == CHIP_SN))       sn76496W(arg[0], &sn);
+        else if (!strcmp(cmd, "REG") && (chip == CHIP_AY))     {ay38910IndexW(arg[0], &ay); ay38910DataW(arg[1], &ay);}
+        else if (!strcmp(cmd, "INDEX") && (chip == CHIP_AY))   ay38910IndexW(arg[0], &ay);
+        else if (!strcmp(cmd, "DATA") && (chip == CHIP_AY))    ay38910DataW(arg[0], &ay);
+        else if (!strcmp(cmd, "WR") && (chip == CHIP_SCC))     SCCWrite(arg[1], arg[0], &scc);
+        else if (!strcmp(cmd, "READ") && (chip != CHIP_SN))
+        {
+            u8 value = (chip == CHIP_AY) ? ay38910DataR(&ay) : SCCRead(arg[0], &scc);
+            Expect(&value, 1, 0, script, lineno, "READ");
+        }
+        else if (!strcmp(cmd, "MIX") && (arg[0] > 0) && (arg[0] <= MAX_MIX))
+        {
+            mixBuf[arg[0]] = 0x5A5A;
+            if (chip == CHIP_SN)      sn76496Mixer(arg[0], mixBuf, &sn);
+            else if (chip == CHIP_AY) ay38910Mixer(arg[0], mixBuf, &ay);
+            else                      SCCMixer(arg[0], mixBuf, &scc);
+            if (mixBuf[arg[0]] != 0x5A5A)
+            {
+                printf("%s:%u: MIX %ld - the mixer wrote past the end of the buffer\n", script, lineno, arg[0]);
+                failed++;
+            }
+            Expect(mixBuf, arg[0] * 2, 1, script, lineno, "MIX");
+            samples += arg[0];
+        }
+        else if (!strcmp(cmd, "SAVE"))
+        {
+            int size = (chip == CHIP_SN) ? sn76496SaveState(saveBuf, &sn) :
+                       (chip == CHIP_AY) ? ay38910SaveState(saveBuf, &ay) : SCCSaveState(saveBuf, &scc);
+            Expect(saveBuf, size, 0, script, lineno, "SAVE");
+        }
+        else if (!strcmp(cmd, "LOAD"))
+        {
+            if (chip == CHIP_SN)      sn76496LoadState(&sn, saveBuf);
+            else if (chip == CHIP_AY) ay38910LoadState(&ay, saveBuf);
+            else                      SCCLoadState(&scc, saveBuf);
+        }
+        else
+        {
+            printf("%s:%u: unknown command %s\n", script, lineno, cmd);
+            failed++;
+        }
+    }
+    fclose(fp);
+
+    if (goldenPos != goldenLen)
+    {
+        printf("%s: the asm core gave %u more bytes of output\n", script, goldenLen - goldenPos);
+        failed++;
+    }
+
+    return samples;
+}
+
+// ---------------------------------------------------------------------------------------
+// A busy chip for the timing - every channel playing, with noise and the envelope
+// ---------------------------------------------------------------------------------------
+static void SetupBusyChip(u8 chip)
+{
+    static const u8 snWrites[] = {0x8E, 0x0F, 0x90, 0xA5, 0x07, 0xB3, 0xCA, 0x02, 0xD6, 0xE5, 0xF8};
+    static const u8 ayRegs[] = {0x55, 0x01, 0x9A, 0x00, 0x21, 0x02, 0x07, 0x20, 0x0F, 0x10, 0x0B, 0x30, 0x00, 0x0E};
+
+    if (chip == CHIP_SN)
+    {
+        sn76496Reset(1, &sn);
+        for (u8 i=0; i<sizeof(snWrites); i++) sn76496W(snWrites[i], &sn);
+    }
+    else if (chip == CHIP_AY)
+    {
+        ay38910Reset(&ay);
+        for (u8 i=0; i<sizeof(ayRegs); i++) {ay38910IndexW(i, &ay); ay38910DataW(ayRegs[i], &ay);}
+    }
+    else
+    {
+        SCCReset(&scc);
+        for (u8 i=0; i<0x80; i++) SCCWrite((u8)((i * 37) ^ (i << 3)), 0x9800 + i, &scc);
+        for (u8 i=0; i<10; i++) SCCWrite((i & 1) ? 0x01 : (u8)(0x40 + i * 0x13), 0x9880 + i, &scc);
+        SCCWrite(0x1F, 0x988F, &scc);
+        for (u8 i=0; i<5; i++) SCCWrite(15 - i, 0x988A + i, &scc);
+    }
+}
+
+static void TimeMixer(u8 chip, const char *name)
+{
+    u32 oversample = (chip == CHIP_SN) ? (1 << SN_SHIFT) : (1 << AY_SHIFT);
+
+    SetupBusyChip(chip);
+
+    double start = NowUsec();
+    for (u32 done=0; done<TIMED_SAMPLES; done += TIMED_CHUNK)
+    {
+        if (chip == CHIP_SN)      sn76496Mixer(TIMED_CHUNK, mixBuf, &sn);
+        else if (chip == CHIP_AY) ay38910Mixer(TIMED_CHUNK, mixBuf, &ay);
+        else                      SCCMixer(TIMED_CHUNK, mixBuf, &scc);
+    }
+    double usec = NowUsec() - start;
+    double rate = TIMED_SAMPLES / usec;
+
+    // SCCMULT only scales the SCC pitch step - it has no oversampling to count
+    if (chip == CHIP_SCC) printf("%-3s  %7.2f Msamples/s                        ", name, rate);
+    else printf("%-3s  %7.2f Msamples/s  %7.2f Msteps/s (x%u)  ", name, rate, rate * oversample, oversample);
+    printf("%6.0fx real time at %u Hz\n", (rate * 1000000.0) / sample_rate, sample_rate);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *chips[] = {"sn", "ay", "scc"};
+    u8 chip = 0;
+
+    while ((argc == 4) && (chip < 3) && strcmp(argv[1], chips[chip])) chip++;
+    if ((argc != 4) || (chip == 3))
+    {
+        fprintf(stderr, "usage: soundtest sn|ay|scc script.snd golden.bin\n");
+        return 2;
+    }
+
+    FILE *fp = fopen(argv[3], "rb");
+    if (!fp)
+    {
+        fprintf(stderr, "soundtest: can't read %s\n", argv[3]);
+        return 2;
+    }
+    fseek(fp, 0, SEEK_END);
+    goldenLen = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    golden = malloc(goldenLen + 1);
+    if (!golden || (fread(golden, 1, goldenLen, fp) != goldenLen))
+    {
+        fprintf(stderr, "soundtest: can't read %s\n", argv[3]);
+        fclose(fp);
+        return 2;
+    }
+    fclose(fp);
+
+    u32 samples = RunScript(chip, argv[2]);
+    if (!samples && !failed)
+    {
+        fprintf(stderr, "soundtest: can't read %s\n", argv[2]);
+        return 2;
+    }
+
+    printf("%-3s  SN_UPSHIFT=%d AY_UPSHIFT=%d SCCMULT=%d  %u samples against %s - %s\n", chips[chip],
+           SN_SHIFT, AY_SHIFT, SCC_MULT, samples, argv[3], (failed ? "DIFFERS" : "same as the asm core"));
+    TimeMixer(chip, chips[chip]);
+
+    free(golden);
+
+    return (failed ? 1 : 0);
+}
+
+// End of file
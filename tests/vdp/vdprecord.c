@@ -0,0 +1,207 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "colecoDS.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "vdpcapture.h"
+#include "CRC32.h"
+#include "hoststubs.h"
+
+// ---------------------------------------------------------------------------------------
+// Records a .vdp capture on the host with the real recorder in vdpcapture.c. A scripted
+// "game" drives the VDP ports line by line through Loop9918() - moving sprites every
+// frame, rewriting the name table, changing the backdrop and a pattern in the middle of
+// the visible frame, reading status and VRAM back and switching between the screen
+// modes. The CRC of every frame as it was drawn live goes out as the .gld so that
+// vdpreplay can check it reproduces the session exactly. The same script is also run
+// with the deferred renderer, which must draw the same frames as the line renderer.
+//
+//    vdprecord capture.vdp capture.gld
+// ---------------------------------------------------------------------------------------
+#define REC_FRAMES  30
+
+extern u8   frameSkipIdx;
+extern byte Loop9918(void);
+
+static void VdpReg(u8 reg, u8 value)
+{
+    WrCtrl9918(value);
+    WrCtrl9918(0x80 | reg);
+}
+
+static void VdpWriteAddr(u16 addr)
+{
+    WrCtrl9918(addr & 0xFF);
+    WrCtrl9918(0x40 | (addr >> 8));
+}
+
+static void VdpReadAddr(u16 addr)
+{
+    WrCtrl9918(addr & 0xFF);
+    WrCtrl9918(addr >> 8);
+}
+
+// ---------------------------------------------------------------------------------------
+// Graphic 2 with the usual ColecoVision table layout: patterns at 0x0000, names at 0x1800,
+// sprite attributes at 0x1B00, colors at 0x2000 and sprite patterns at 0x3800.
+// ---------------------------------------------------------------------------------------
+static const u8 StartRegs[8] = {0x02, 0xE2, 0x06, 0xFF, 0x03, 0x36, 0x07, 0x04};
+
+static void SetupScreen(void)
+{
+    for (u8 reg=0; reg<8; reg++) VdpReg(reg, StartRegs[reg]);
+
+    VdpWriteAddr(0x0000);
+    for (u16 i=0; i<0x1800; i++) WrData9918((u8)((i * 7) ^ (i >> 5)));                 // Patterns
+    VdpWriteAddr(0x1800);
+    for (u16 i=0; i<0x300; i++) WrData9918((u8)(i + (i >> 5)));                         // Names
+    VdpWriteAddr(0x1B00);
+    WrData9918(208);                                                                    // No sprites yet
+    VdpWriteAddr(0x2000);
+    for (u16 i=0; i<0x1800; i++) WrData9918((u8)(((i >> 3) & 0xF0) | ((i + 3) & 0x0F)) | 0x11);  // Colors
+    VdpWriteAddr(0x3800);
+    for (u16 i=0; i<0x800; i++) WrData9918((u8)(0x81 ^ (i * 0x25)));                    // Sprite patterns
+}
+
+// ---------------------------------------------------------------------------------------
+// What the "game" does on line 'line' (0 = first line after vertical blank) of frame 'f'
+// ---------------------------------------------------------------------------------------
+static void Script(u32 f, u16 line)
+{
+    u16 visible = line - tms_start_line;
+
+    if (line == 0)
+    {
+        RdCtrl9918();                                   // Acknowledge the frame interrupt
+
+        // Walk through the screen modes: graphic 2, text, multicolor then zoomed graphic 1
+        if (f == 12) {VdpReg(0, 0x00); VdpReg(1, 0xF0);}
+        if (f == 18) VdpReg(1, 0xEB);
+        if (f == 24) VdpReg(1, 0xE1);
+
+        // Move 8 sprites - the last one has the early clock bit and walks off the left
+        VdpWriteAddr(0x1B00);
+        for (u8 i=0; i<8; i++)
+        {
+            WrData9918((u8)(8 + i*21 + f*2));
+            WrData9918((u8)(i*30 + f*5));
+            WrData9918(i*4);
+            WrData9918((i == 7 ? 0x80 : 0x00) | (2 + i));
+        }
+        WrData9918(208);
+
+        // Scroll a row of the name table every other frame
+        if (f & 1)
+        {
+            u8 row = (f / 2) % 24;
+            VdpWriteAddr(0x1800 + row*32);
+            for (u8 x=0; x<32; x++) WrData9918((u8)(x + f));
+        }
+    }
+    else if (visible == 96)
+    {
+        VdpReg(7, (u8)(0x10 | (f & 0x0F)));            // Backdrop change in the middle of the picture
+    }
+    else if (visible == 100)
+    {
+        VdpWriteAddr(0x1000 + (f & 0x7F)*8);            // Change a pattern in the bottom third while it's drawn
+        for (u8 i=0; i<8; i++) WrData9918((u8)(0xAA >> (i & 3)) ^ f);
+    }
+    else if (visible == 140)
+    {
+        VdpReg(7, StartRegs[7]);
+    }
+    else if (visible == 180)
+    {
+        VdpReadAddr(0x1800);                            // Read some VRAM back - moves VAddr and the read latch
+        for (u8 i=0; i<4; i++) RdData9918();
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Run the script for REC_FRAMES frames with the given renderer and keep the frame CRCs
+// ---------------------------------------------------------------------------------------
+static void RunScript(u8 render, u8 bCapture, u32 *crcs)
+{
+    HostReset9918();
+    myConfig.vdpRender = render;
+    myConfig.frameSkip = 0;
+    myConfig.vertSync  = 0;
+    myGlobalConfig.debugger = 3;                        // Loop9918() keeps the CRC of each frame in vdp_frame_crc
+    frameSkipIdx = 1;                                   // Index 0 is a skipped frame even with frameskip off
+
+    SetupScreen();
+    CurLine = tms_num_lines - 1;                        // So the first Loop9918() starts a new frame
+
+    if (bCapture) VDPCaptureStart();
+
+    for (u32 f=0; f<REC_FRAMES; f++)
+    {
+        for (u16 i=0; i<tms_num_lines; i++)
+        {
+            Loop9918();
+            if (CurLine == tms_end_line) crcs[f] = vdp_frame_crc;
+            Script(f, CurLine);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    u32 lineCRC[REC_FRAMES], deferredCRC[REC_FRAMES];
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: vdprecord capture.vdp capture.gld\n");
+        return 2;
+    }
+
+    host_dsi_mode = 1;                                  // Only the DSi has the memory for a capture
+    RunScript(VDP_RENDER_LINE, 1, lineCRC);
+
+    if (!VDPCaptureStop() || (rename(vdp_cap_last, argv[1]) != 0))
+    {
+        fprintf(stderr, "vdprecord: can't write %s\n", argv[1]);
+        return 2;
+    }
+
+    FILE *fp = fopen(argv[2], "w");
+    if (!fp)
+    {
+        fprintf(stderr, "vdprecord: can't write %s\n", argv[2]);
+        return 2;
+    }
+    fprintf(fp, "VDP RECORD %s  FRAMES %d\nFRAME     NSEC     USEC       CRC\n", argv[1], REC_FRAMES);
+    for (u32 f=0; f<REC_FRAMES; f++) fprintf(fp, "%5u %8u %8u  %08X\n", f, 0, 0, lineCRC[f]);
+    fclose(fp);
+
+    RunScript(VDP_RENDER_DEFERRED, 0, deferredCRC);
+
+    u32 differ = 0;
+    for (u32 f=0; f<REC_FRAMES; f++)
+    {
+        if (deferredCRC[f] != lineCRC[f])
+        {
+            printf("FRAME %2u  LINE %08X  DEFERRED %08X *\n", f, lineCRC[f], deferredCRC[f]);
+            differ++;
+        }
+    }
+    printf("Recorded %d frames to %s - deferred renderer %s\n", REC_FRAMES, argv[1], (differ ? "DIFFERS" : "matches"));
+
+    return (differ ? 1 : 0);
+}
+
+// End of file
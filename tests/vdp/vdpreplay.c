@@ -0,0 +1,237 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colecoDS.h"
+#include "colecomngt.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "vdpcapture.h"
+#include "CRC32.h"
+#include "lzav.h"
+#include "hoststubs.h"
+#include "hostsink.h"
+
+// ---------------------------------------------------------------------------------------
+// Host replayer for the .vdp captures written by VDPCaptureStop(). This is VDPReplay()
+// from vdpcapture.c without the DS: the capture is fed through the real port functions
+// and line renderers in tms9918a.c with the same line granularity, every frame is timed
+// and CRC'd, and the report has the same four columns as the .txt the DS writes (with
+// nanoseconds in place of TIMER3 ticks) so a report from either side can be used as the
+// .gld for the other.
+//
+// Each frame then goes through the real frame sink (colecoUpdateScreen) with the frame
+// blend option picked by --blend, and from the display to the host sink consumers: a
+// hash of every frame shown (checked against --hash if given), a raw dump and/or PNG
+// files of every Nth frame.
+//
+//    vdpreplay [--gld golden.gld] [--blend off|cpu|layers] [--hash XXXXXXXX]
+//              [--raw frames.raw] [--png prefix] [--every N] capture.vdp
+//
+// Exit status is 0 if the capture replayed (and matched the golden CRCs and hash if
+// given), 1 if any frame differs from the golden CRCs, the display didn't show what
+// was drawn or the hash differs, and 2 if the capture couldn't be read.
+// ---------------------------------------------------------------------------------------
+static double NowUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static u8 *ReadCapture(const char *filename, u32 *raw_len)
+{
+    u32 comp_len = 0;
+    *raw_len = 0;
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+    if ((fread(raw_len, sizeof(u32), 1, fp) != 1) || (fread(&comp_len, sizeof(u32), 1, fp) != 1) ||
+        (*raw_len < (sizeof(tVDPCapHeader) + 0x4000)))
+    {
+        fclose(fp);
+        return 0;
+    }
+
+    u8 *raw  = malloc(*raw_len);
+    u8 *comp = malloc(comp_len);
+    if (!raw || !comp || (fread(comp, comp_len, 1, fp) != 1) || (lzav_decompress(comp, raw, comp_len, *raw_len) != (int)*raw_len))
+    {
+        fclose(fp);
+        free(comp);
+        free(raw);
+        return 0;
+    }
+    fclose(fp);
+    free(comp);
+
+    return raw;
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *blendNames[] = {"off", "cpu", "layers"};
+    const char *capFile = 0, *goldFile = 0, *pngPrefix = 0, *rawFile = 0;
+    u32 pngEvery = 1, hash = 0;
+    u8  blend = FRAME_BLEND_OFF, bHash = 0, bBadArg = 0;
+    char goldLine[128];
+
+    for (int i=1; i<argc; i++)
+    {
+        if      (!strcmp(argv[i], "--gld")   && (i+1 < argc)) goldFile  = argv[++i];
+        else if (!strcmp(argv[i], "--raw")   && (i+1 < argc)) rawFile   = argv[++i];
+        else if (!strcmp(argv[i], "--png")   && (i+1 < argc)) pngPrefix = argv[++i];
+        else if (!strcmp(argv[i], "--every") && (i+1 < argc)) pngEvery  = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--hash")  && (i+1 < argc)) {hash = strtoul(argv[++i], 0, 16); bHash = 1;}
+        else if (!strcmp(argv[i], "--blend") && (i+1 < argc))
+        {
+            i++;
+            for (blend=0; (blend<3) && strcmp(argv[i], blendNames[blend]); blend++) ;
+            if (blend == 3) bBadArg = 1;
+        }
+        else capFile = argv[i];
+    }
+    if (!capFile || !pngEvery || bBadArg)
+    {
+        fprintf(stderr, "usage: vdpreplay [--gld golden.gld] [--blend off|cpu|layers] [--hash XXXXXXXX]\n"
+                        "                 [--raw frames.raw] [--png prefix] [--every N] capture.vdp\n");
+        return 2;
+    }
+
+    u32 raw_len;
+    u8 *raw = ReadCapture(capFile, &raw_len);
+    if (!raw)
+    {
+        fprintf(stderr, "vdpreplay: can't read %s\n", capFile);
+        return 2;
+    }
+
+    tVDPCapHeader *hdr = (tVDPCapHeader *)raw;
+    tVDPCapEntry *entry = (tVDPCapEntry *)(raw + sizeof(tVDPCapHeader) + 0x4000);
+    if ((hdr->magic != VDP_CAP_MAGIC) || (hdr->version != VDP_CAP_VERSION) ||
+        (hdr->entries > ((raw_len - sizeof(tVDPCapHeader) - 0x4000) / sizeof(tVDPCapEntry))))
+    {
+        fprintf(stderr, "vdpreplay: %s is not a version %d capture\n", capFile, VDP_CAP_VERSION);
+        free(raw);
+        return 2;
+    }
+
+    FILE *gold = 0;
+    if (goldFile && !(gold = fopen(goldFile, "r")))
+    {
+        fprintf(stderr, "vdpreplay: can't read %s\n", goldFile);
+        free(raw);
+        return 2;
+    }
+
+    u8 consumers = HOST_SINK_HASH | (rawFile ? HOST_SINK_RAW : 0) | (pngPrefix ? HOST_SINK_PNG : 0);
+    if (!HostSinkOpen(consumers, rawFile, pngPrefix, pngEvery))
+    {
+        fprintf(stderr, "vdpreplay: can't write %s\n", rawFile);
+        if (gold) fclose(gold);
+        free(raw);
+        return 2;
+    }
+
+    // Put the VDP into the state the capture started from - just as VDPReplay() does
+    HostReset9918();
+    myConfig.frameBlend = blend;
+    memcpy(pVDPVidMem, raw + sizeof(tVDPCapHeader), 0x4000);
+    for (u8 reg=0; reg<8; reg++) Write9918(reg, hdr->VDP[reg]);
+    VAddr        = hdr->VAddr;
+    VDPStatus    = hdr->VDPStatus;
+    VDPDlatch    = hdr->VDPDlatch;
+    VDPCtrlLatch = hdr->VDPCtrlLatch;
+    tms_start_line = hdr->start_line;
+    tms_num_lines  = hdr->num_lines;
+    tms_cpu_line   = hdr->cpu_line;
+
+    printf("VDP REPLAY %s  MODE %d  LINES %d  START %d  ENTRIES %u\nFRAME     NSEC     USEC       CRC\n",
+           capFile, hdr->machine_mode, hdr->num_lines, hdr->start_line, hdr->entries);
+
+    u32 frames = 0, golden = 0, differ = 0;
+    double total = 0, slowest = 0;
+    u8  line = 0;
+    u16 end_line = hdr->start_line + 192;
+
+    SelectSink9918();
+    double start = NowUsec();
+
+    for (u32 i=0; i<hdr->entries; i++, entry++)
+    {
+        if ((entry->line >= hdr->start_line) && (entry->line < end_line))
+        {
+            CurLine = entry->line;
+            while (line <= (entry->line - hdr->start_line)) RefreshLine(line++);
+        }
+
+        switch (entry->type)
+        {
+            case VDP_CAP_DATA_WR: WrData9918(entry->value); break;
+            case VDP_CAP_CTRL_WR: WrCtrl9918(entry->value); break;
+            case VDP_CAP_DATA_RD: RdData9918();             break;
+            case VDP_CAP_CTRL_RD: RdCtrl9918();             break;
+            case VDP_CAP_FRAME:
+            {
+                while (line < 192) RefreshLine(line++);
+                double usec = NowUsec() - start;
+                u32 crc = getCRC32(XBuf, 256*192);
+
+                u32 goldFrame, goldTicks, goldUsec, goldCRC;
+                u8 mismatch = 0;
+                while (gold && fgets(goldLine, sizeof(goldLine), gold))
+                {
+                    if (sscanf(goldLine, "%u %u %u %X", &goldFrame, &goldTicks, &goldUsec, &goldCRC) != 4) continue;
+                    golden++;
+                    if (goldCRC != crc) {mismatch = 1; differ++;}
+                    break;
+                }
+                printf("%5u %8u %8u  %08X%s\n", frames, (u32)(usec * 1000.0), (u32)usec, crc, (mismatch ? " *" : ""));
+
+                total += usec;
+                if (usec > slowest) slowest = usec;
+                frames++;
+                line = 0;
+                colecoUpdateScreen();
+                HostSinkFrame();
+                SelectSink9918();
+                start = NowUsec();
+                break;
+            }
+        }
+    }
+
+    HostSinkClose();
+
+    if (frames) printf("FRAMES %u  AVERAGE %.2f USEC  SLOWEST %.2f USEC\n", frames, total / frames, slowest);
+    u8 bHashDiffers = (bHash && (host_sink_hash != hash));
+    printf("SINK %s  HASH %08X  %u FRAMES SHOWN  %u WRONG%s\n", blendNames[blend], host_sink_hash, host_sink_frames, host_sink_errors,
+           (bHashDiffers ? "  (HASH DIFFERS)" : ""));
+    if (gold)
+    {
+        // Any golden frames we didn't get to count as a difference
+        u32 goldFrame, goldTicks, goldUsec, goldCRC;
+        while (fgets(goldLine, sizeof(goldLine), gold))
+            if (sscanf(goldLine, "%u %u %u %X", &goldFrame, &goldTicks, &goldUsec, &goldCRC) == 4) golden++;
+        fclose(gold);
+        printf("GOLDEN %u CHECKED  %u DIFFER%s\n", golden, differ, ((golden != frames) ? "  (FRAME COUNT DIFFERS)" : ""));
+    }
+
+    free(raw);
+
+    return ((differ || (gold && (golden != frames)) || host_sink_errors || bHashDiffers) ? 1 : 0);
+}
+
+// End of file
@@ -0,0 +1,314 @@
+// =====================================================================================
+// Copyright (c) 2021-2025 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave (Phoenix-Edition),
+// Alekmaul (original port) and Marat Fayzullin (ColEM core) are thanked profusely.
+//
+// The ColecoDS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colecoDS.h"
+#include "colecogeneric.h"
+#include "cpu/tms9918a/tms9918a.h"
+#include "CRC32.h"
+#include "hoststubs.h"
+
+// ---------------------------------------------------------------------------------------
+// Host harness for the TMS9918A line renderers. Each test builds a VDP state from a
+// fixed seed (random VRAM, then a known sprite attribute table), renders one frame of
+// 192 lines through RefreshLine() exactly as Loop9918() does and checks the CRC32 of
+// XBuf, the status register (5th sprite flag and number) and the collision result
+// against the recorded values in vdptest.crc. Any renderer change that moves a single
+// pixel of any of these frames shows up here. Each frame is then redrawn from scratch
+// a few hundred times to give the time per frame of every mode.
+//
+//    vdptest vdptest.crc             Check against the recorded results
+//    vdptest --update vdptest.crc    Record the results (after an intended change)
+// ---------------------------------------------------------------------------------------
+extern byte CheckSprites(void);
+
+#define TIMED_FRAMES    500
+
+#define SPR_NONE        0       // Sprite table starts with the Y=208 terminator
+#define SPR_EDGES       1       // Sprites clipped at every edge, early clock, transparent and past the terminator
+#define SPR_CROWD       2       // More than 4 (and 8) sprites on the same lines, overlapping
+
+typedef struct {
+    const char *name;
+    const char *mode;           // Which renderer the time goes against
+    u8  regs[8];
+    u8  sprites;                // SPR_xxx layout written to the sprite attribute table
+    u8  maxSprites;             // myConfig.maxSprites - 0 = 32 per line, 1 = 4 like a real 9918
+} tVDPTest;
+
+// Graphic 1 and 2 are run with all four sprite sizes: 8x8, 8x8 zoomed, 16x16 and 16x16 zoomed
+#define G1(sz)  {0x00, 0xC0|(sz), 0x06, 0x80, 0x00, 0x36, 0x07, 0x04}
+#define G2(sz)  {0x02, 0xC0|(sz), 0x06, 0xFF, 0x03, 0x36, 0x07, 0x01}
+#define G2M(sz) {0x02, 0xC0|(sz), 0x06, 0x9F, 0x00, 0x36, 0x07, 0x01}
+
+tVDPTest tests[] = {
+    {"text",            "text",  {0x00, 0xD0, 0x02, 0x00, 0x00, 0x36, 0x07, 0xF4}, SPR_EDGES, 0},
+    {"text-half",       "text",  {0x00, 0xD8, 0x02, 0x00, 0x00, 0x36, 0x07, 0x1E}, SPR_EDGES, 0},  // Undocumented mode 1+2
+    {"text-4k",         "text",  {0x00, 0x50, 0x0B, 0x00, 0x03, 0x36, 0x07, 0x75}, SPR_NONE,  0},
+    {"g1-8",            "g1",    G1(0),  SPR_EDGES, 0},
+    {"g1-8z",           "g1",    G1(1),  SPR_EDGES, 0},
+    {"g1-16",           "g1",    G1(2),  SPR_EDGES, 0},
+    {"g1-16z",          "g1",    G1(3),  SPR_EDGES, 0},
+    {"g1-8-crowd",      "g1",    G1(0),  SPR_CROWD, 0},
+    {"g1-8-crowd4",     "g1",    G1(0),  SPR_CROWD, 1},
+    {"g1-16z-crowd",    "g1",    G1(3),  SPR_CROWD, 0},
+    {"g1-16z-crowd4",   "g1",    G1(3),  SPR_CROWD, 1},
+    {"g1-nospr",        "g1",    G1(0),  SPR_NONE,  0},
+    {"g2-8",            "g2",    G2(0),  SPR_EDGES, 0},
+    {"g2-8z",           "g2",    G2(1),  SPR_EDGES, 0},
+    {"g2-16",           "g2",    G2(2),  SPR_EDGES, 0},
+    {"g2-16z",          "g2",    G2(3),  SPR_EDGES, 0},
+    {"g2-8-crowd",      "g2",    G2(0),  SPR_CROWD, 0},
+    {"g2-8-crowd4",     "g2",    G2(0),  SPR_CROWD, 1},
+    {"g2-16-crowd",     "g2",    G2(2),  SPR_CROWD, 0},
+    {"g2-16-crowd4",    "g2",    G2(2),  SPR_CROWD, 1},
+    {"g2-nospr",        "g2",    G2(0),  SPR_NONE,  0},
+    {"g2-bitmaptext",   "g2",    {0x02, 0xC8, 0x06, 0xFF, 0x03, 0x36, 0x07, 0x01}, SPR_EDGES, 0},  // Undocumented mode 2+3
+    {"g2-4k",           "g2",    {0x02, 0x42, 0x06, 0xFF, 0x03, 0x36, 0x07, 0x01}, SPR_EDGES, 0},
+    {"g2m-8",           "g2m",   G2M(0), SPR_EDGES, 0},
+    {"g2m-16z",         "g2m",   G2M(3), SPR_EDGES, 0},
+    {"g2m-16-crowd4",   "g2m",   G2M(2), SPR_CROWD, 1},
+    {"g2m-half",        "g2m",   {0x02, 0xC2, 0x0E, 0x87, 0x01, 0x36, 0x07, 0x01}, SPR_NONE,  0},
+    {"mc-8",            "mc",    {0x00, 0xC8, 0x06, 0x80, 0x00, 0x36, 0x07, 0x05}, SPR_EDGES, 0},
+    {"mc-16z-crowd",    "mc",    {0x00, 0xCB, 0x06, 0x80, 0x00, 0x36, 0x07, 0x05}, SPR_CROWD, 0},
+    {"mc-16z-crowd4",   "mc",    {0x00, 0xCB, 0x06, 0x80, 0x00, 0x36, 0x07, 0x05}, SPR_CROWD, 1},
+    {"off-g2",          "off",   {0x02, 0x82, 0x06, 0xFF, 0x03, 0x36, 0x07, 0x0D}, SPR_EDGES, 0},
+    {"off-text",        "off",   {0x00, 0x90, 0x02, 0x00, 0x00, 0x36, 0x07, 0xF4}, SPR_NONE,  0},
+};
+#define NUM_TESTS (sizeof(tests)/sizeof(tests[0]))
+
+// ---------------------------------------------------------------------------------------
+// Sprite layouts. Each entry is Y, X, pattern, early clock + color. The edge layout puts
+// sprites across the left border with the early clock bit (X-32 down to fully hidden),
+// across the right border, over the top (Y wrapping past 255) and the bottom, with one
+// transparent sprite and sprites after the Y=208 terminator that must never be drawn.
+// The crowd layout stacks 12 sprites on the same lines (overlapping at the start) so
+// that the 5th sprite flag and MaxSprites both cut in, and then staggers 8 more.
+// ---------------------------------------------------------------------------------------
+static const u8 SprEdges[][4] = {
+    {  10,   0,  0, 0x8F},      // X-32 = -32: hidden even when zoomed to 32 pixels
+    {  10,  20,  4, 0x81},      // X-32 = -12
+    {  30,  28,  8, 0x82},      // X-32 = -4
+    {  30,  31, 12, 0x83},      // X-32 = -1
+    {  50, 250, 16, 0x04},      // Right border
+    {  50, 255, 20, 0x05},
+    {  70, 241, 24, 0x06},
+    {  70, 225, 28, 0x87},      // Early clock near the right border is fully visible
+    {0xF8, 100, 32, 0x08},      // Y = -8 so only the bottom of the sprite shows
+    {0xFF, 120, 36, 0x09},      // Y = -1 - first line of the sprite is screen line 0
+    {0xEF, 140, 40, 0x0A},      // Y = -17
+    { 185,  60, 44, 0x0B},      // Runs off the bottom
+    { 191,  80, 48, 0x0C},      // Starts on the last line
+    { 120, 128, 52, 0x00},      // Transparent - not drawn
+    { 120, 136, 56, 0x0D},
+    { 208,   0,  0, 0x0F},      // Terminator
+    { 100, 100, 60, 0x0E},      // Never drawn
+};
+
+static void SetupSprites(u8 layout)
+{
+    u8 *sat = SprTab;
+
+    if (layout == SPR_EDGES)
+    {
+        memcpy(sat, SprEdges, sizeof(SprEdges));
+    }
+    else if (layout == SPR_CROWD)
+    {
+        for (int i=0; i<32; i++)
+        {
+            if (i < 12)
+            {
+                sat[i*4+0] = 60 + (i&1);                // Two staggered rows on the same lines
+                sat[i*4+1] = 8 + i*18;                  // 18 apart so 16x16 and zoomed ones overlap
+            }
+            else if (i < 20)
+            {
+                sat[i*4+0] = 100 + (i-12)*3;            // Staircase - each line sees a different number
+                sat[i*4+1] = 40 + (i-12)*5;
+            }
+            else
+            {
+                sat[i*4+0] = 140;                       // Piled on top of each other
+                sat[i*4+1] = 100 + (i&3);
+            }
+            sat[i*4+2] = i*4;
+            sat[i*4+3] = 1 + (i % 15);
+        }
+    }
+    else
+    {
+        sat[0] = 208;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Fixed seed random fill so that every table in every mode has something on it
+// ---------------------------------------------------------------------------------------
+static u32 rng_state;
+
+static u8 NextRandom(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (u8)(rng_state >> 24);
+}
+
+static void SetupTest(u32 idx)
+{
+    tVDPTest *t = &tests[idx];
+
+    HostReset9918();
+    myConfig.maxSprites = t->maxSprites;
+
+    rng_state = 0x9918A000 + idx;
+    for (int i=0; i<0x4000; i++) pVDPVidMem[i] = NextRandom();
+
+    for (u8 reg=0; reg<8; reg++) Write9918(reg, t->regs[reg]);
+    SetupSprites(t->sprites);
+}
+
+static void RenderFrame(void)
+{
+    for (u8 line=0; line<192; line++)
+    {
+        CurLine = tms_start_line + line;
+        RefreshLine(line);
+    }
+}
+
+static double NowUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    u8 bUpdate = 0;
+    const char *crcFile = 0;
+
+    for (int i=1; i<argc; i++)
+    {
+        if (!strcmp(argv[i], "--update")) bUpdate = 1;
+        else crcFile = argv[i];
+    }
+    if (!crcFile)
+    {
+        fprintf(stderr, "usage: vdptest [--update] vdptest.crc\n");
+        return 2;
+    }
+
+    u32 goldCRC[NUM_TESTS];
+    u32 goldStatus[NUM_TESTS];
+    u32 goldCollide[NUM_TESTS];
+    u8  goldFound[NUM_TESTS];
+    memset(goldFound, 0x00, sizeof(goldFound));
+
+    if (!bUpdate)
+    {
+        char line[128], name[64];
+        u32 crc, status, collide;
+        FILE *fp = fopen(crcFile, "r");
+        if (!fp)
+        {
+            fprintf(stderr, "vdptest: can't read %s (run with --update to record it)\n", crcFile);
+            return 2;
+        }
+        while (fgets(line, sizeof(line), fp))
+        {
+            if (sscanf(line, "%63s %x %x %u", name, &crc, &status, &collide) != 4) continue;
+            for (u32 i=0; i<NUM_TESTS; i++)
+            {
+                if (strcmp(name, tests[i].name)) continue;
+                goldCRC[i] = crc; goldStatus[i] = status; goldCollide[i] = collide; goldFound[i] = 1;
+            }
+        }
+        fclose(fp);
+    }
+
+    FILE *out = (bUpdate ? fopen(crcFile, "w") : 0);
+    if (bUpdate && !out)
+    {
+        fprintf(stderr, "vdptest: can't write %s\n", crcFile);
+        return 2;
+    }
+    if (out) fprintf(out, "# TEST          CRC32     STATUS COLLIDE  - written by vdptest --update\n");
+
+    const char *modes[8];
+    double modeUsec[8];
+    u32 modeTests[8];
+    u32 numModes = 0, failed = 0;
+
+    printf("TEST               CRC32    ST  COL  RESULT    USEC/FRAME\n");
+    for (u32 i=0; i<NUM_TESTS; i++)
+    {
+        tVDPTest *t = &tests[i];
+
+        SetupTest(i);
+        VDPStatus = 0x00;
+        RenderFrame();
+        u32 crc     = getCRC32(XBuf, 256*192);
+        u32 status  = VDPStatus;
+        u32 collide = CheckSprites();
+
+        const char *result = "RECORDED";
+        if (!bUpdate)
+        {
+            if (!goldFound[i]) result = "MISSING";
+            else if ((goldCRC[i] != crc) || (goldStatus[i] != status) || (goldCollide[i] != collide)) result = "DIFF";
+            else result = "OK";
+            if (strcmp(result, "OK")) failed++;
+        }
+        if (out) fprintf(out, "%-16s %08X  %02X     %u\n", t->name, crc, status, collide);
+
+        // Time the same frame drawn from scratch - nothing cached from the last frame
+        double start = NowUsec();
+        for (u32 frame=0; frame<TIMED_FRAMES; frame++)
+        {
+            InvalidateTextCache();
+            vdp_changed = 1;
+            RenderFrame();
+        }
+        double usec = (NowUsec() - start) / TIMED_FRAMES;
+
+        printf("%-16s  %08X  %02X   %u   %-8s  %8.2f\n", t->name, crc, status, collide, result, usec);
+
+        u32 m = 0;
+        while ((m < numModes) && strcmp(modes[m], t->mode)) m++;
+        if (m == numModes) {modes[m] = t->mode; modeUsec[m] = 0; modeTests[m] = 0; numModes++;}
+        modeUsec[m] += usec;
+        modeTests[m]++;
+    }
+
+    printf("\nMODE   TESTS  AVG USEC/FRAME\n");
+    for (u32 m=0; m<numModes; m++) printf("%-6s %5u  %8.2f\n", modes[m], modeTests[m], modeUsec[m] / modeTests[m]);
+
+    if (out)
+    {
+        fclose(out);
+        printf("\nRecorded %u tests to %s\n", (u32)NUM_TESTS, crcFile);
+        return 0;
+    }
+
+    if (failed) printf("\n%u of %u tests FAILED\n", failed, (u32)NUM_TESTS);
+    else printf("\nAll %u tests passed\n", (u32)NUM_TESTS);
+
+    return (failed ? 1 : 0);
+}
+
+// End of file